@@ -0,0 +1,221 @@
+#include "benchmark.h"
+
+#include "player_bridge.h"
+#include "state_store.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QUrl>
+#include <QWebEnginePage>
+#include <QWebEngineProfile>
+#include <QtWebEngineCore/qtwebenginecoreglobal.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+// 基准测试使用的本地合成页面：播放栏位于 %1 层 Shadow DOM 之下，每层带 %2 个干扰节点，
+// 用来测量媒体控制桥在最坏情况下的选择器遍历开销
+static const char *benchmark_fixture = R"HTML(<!DOCTYPE html>
+<html><head><meta charset="utf-8"><title>cmw-benchmark</title></head>
+<body>
+<audio preload="none"></audio>
+<div id="root"></div>
+<script>
+(function(){
+    var depth = %1, noise = %2;
+    var parent = document.getElementById('root');
+    for (var d = 0; d < depth; d++) {
+        for (var i = 0; i < noise; i++) {
+            var n = document.createElement('div');
+            n.className = 'noise-' + i;
+            n.textContent = 'item ' + i;
+            parent.appendChild(n);
+        }
+        var host = document.createElement('div');
+        host.className = 'shadow-host';
+        parent.appendChild(host);
+        parent = host.attachShadow({mode: 'open'});
+    }
+    var bar = document.createElement('div');
+    bar.className = 'm-playbar';
+    bar.innerHTML = '<a href="song?id=186016">benchmark</a>' +
+        '<button title="上一首"></button><button title="播放"></button><button title="下一首"></button>';
+    parent.appendChild(bar);
+})();
+</script>
+</body></html>
+)HTML";
+
+void Benchmark::start() {
+    QElapsedTimer timer;
+    timer.start();
+    m_profile = new QWebEngineProfile(this); // 无存储名：off-the-record，不触碰播放器的数据
+    m_page = new QWebEnginePage(m_profile, this);
+    installPlayerBridge(m_page);
+    loadFixture(timer, [this](qint64 ns) {
+        addSample("startup_cold", ns);
+        measureClick("bridge_click_uncached", [this]() { warmLoads(m_iterations); });
+    });
+}
+
+int Benchmark::iterationsFromArguments(const QStringList &args) {
+    for (const QString &arg : args) {
+        if (arg.startsWith("--iterations=")) return qMax(1, arg.mid(int(qstrlen("--iterations="))).toInt());
+    }
+    return kDefaultIterations;
+}
+
+QString Benchmark::fixtureHtml() {
+    return QString::fromUtf8(benchmark_fixture).arg(kShadowDepth).arg(kNoisePerLevel);
+}
+
+void Benchmark::loadFixture(QElapsedTimer timer, const std::function<void(qint64)> &done) {
+    auto conn = std::make_shared<QMetaObject::Connection>();
+    *conn = connect(m_page, &QWebEnginePage::loadFinished, this, [this, conn, timer, done](bool ok) {
+        disconnect(*conn);
+        if (!ok) {
+            fail("fixture page failed to load");
+            return;
+        }
+        done(timer.nsecsElapsed());
+    });
+    m_page->setHtml(fixtureHtml(), QUrl("http://localhost/cmw-benchmark"));
+}
+
+void Benchmark::warmLoads(int remaining) {
+    if (remaining == 0) {
+        repeatJs("bridge_click", QStringLiteral("window.__cmw ? __cmw.run([\"next\"]) : null"), m_iterations, [this]() {
+            repeatJs("bridge_state", QStringLiteral("window.__cmw ? __cmw.state() : null"), m_iterations, [this]() {
+                measureStateWrites();
+                finish();
+            });
+        });
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    loadFixture(timer, [this, remaining](qint64 ns) {
+        addSample("startup_warm", ns);
+        measureClick("bridge_click_uncached", [this, remaining]() { warmLoads(remaining - 1); });
+    });
+}
+
+void Benchmark::measureClick(const QString &name, const std::function<void()> &next) {
+    repeatJs(name, QStringLiteral("window.__cmw ? __cmw.run([\"next\"]) : null"), 1, next);
+}
+
+void Benchmark::repeatJs(const QString &name, const QString &js, int count, const std::function<void()> &next) {
+    if (count == 0) {
+        next();
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    m_page->runJavaScript(js, kBridgeWorldId, [this, name, js, count, next, timer](const QVariant &v) {
+        const qint64 ns = timer.nsecsElapsed();
+        if (!v.isValid() || v.isNull()) {
+            fail("media bridge not available on fixture page");
+            return;
+        }
+        addSample(name, ns);
+        repeatJs(name, js, count - 1, next);
+    });
+}
+
+void Benchmark::measureStateWrites() {
+    const QString path = QDir(m_outputDir).filePath("benchmark_state.json");
+    StateStore store(path);
+    QJsonObject state;
+    state["id"] = "186016";
+    state["title"] = "benchmark";
+    state["duration"] = 269.0;
+    state["paused"] = false;
+    for (int i = 0; i < m_iterations; ++i) {
+        // 每次换一首，使 recent 环和实际写入路径都被覆盖
+        state["id"] = QString::number(186016 + i % 10);
+        state["time"] = double(i);
+        QElapsedTimer timer;
+        timer.start();
+        store.update(state);
+        store.flush();
+        addSample("state_write", timer.nsecsElapsed());
+    }
+    QFile::remove(path);
+}
+
+void Benchmark::addSample(const QString &name, qint64 ns) {
+    if (!m_samples.contains(name)) m_order.append(name);
+    m_samples[name].append(ns / 1000.0);
+}
+
+void Benchmark::fail(const QString &reason) {
+    qWarning() << "Benchmark failed:" << reason;
+    delete m_page;
+    m_page = nullptr;
+    emit finished(false);
+}
+
+void Benchmark::finish() {
+    // 页面必须先于 profile 释放
+    delete m_page;
+    m_page = nullptr;
+
+    QJsonArray results;
+    QString csv = "name,iterations,mean_us,median_us,min_us,max_us,qt_version\n";
+    for (const QString &name : std::as_const(m_order)) {
+        QList<double> v = m_samples.value(name);
+        std::sort(v.begin(), v.end());
+        double total = 0.0;
+        for (double x : std::as_const(v)) total += x;
+        const double mean = total / v.size();
+        const double median = v.size() % 2 ? v.at(v.size() / 2) : (v.at(v.size() / 2 - 1) + v.at(v.size() / 2)) / 2.0;
+
+        QJsonObject r;
+        r["name"] = name;
+        r["iterations"] = v.size();
+        r["mean_us"] = mean;
+        r["median_us"] = median;
+        r["min_us"] = v.first();
+        r["max_us"] = v.last();
+        results.append(r);
+        csv += QString("%1,%2,%3,%4,%5,%6,%7\n").arg(name).arg(v.size())
+            .arg(mean, 0, 'f', 1).arg(median, 0, 'f', 1).arg(v.first(), 0, 'f', 1).arg(v.last(), 0, 'f', 1)
+            .arg(QString::fromLatin1(qVersion()));
+        qDebug().noquote() << QString("Benchmark: %1 median %2 us (min %3, max %4, n=%5)")
+            .arg(name).arg(median, 0, 'f', 1).arg(v.first(), 0, 'f', 1).arg(v.last(), 0, 'f', 1).arg(v.size());
+    }
+
+    QJsonObject root;
+    root["qt_version"] = QString::fromLatin1(qVersion());
+    root["chromium_version"] = QString::fromLatin1(qWebEngineChromiumVersion());
+    root["shadow_depth"] = kShadowDepth;
+    root["noise_per_level"] = kNoisePerLevel;
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["results"] = results;
+
+    const bool ok = writeFile("benchmark.json", QJsonDocument(root).toJson())
+        && writeFile("benchmark.csv", csv.toUtf8());
+    emit finished(ok);
+}
+
+bool Benchmark::writeFile(const QString &name, const QByteArray &data) const {
+    QSaveFile f(QDir(m_outputDir).filePath(name));
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write benchmark results:" << f.errorString();
+        return false;
+    }
+    f.write(data);
+    if (!f.commit()) {
+        qWarning() << "Failed to write benchmark results:" << f.errorString();
+        return false;
+    }
+    qDebug().noquote() << "Benchmark results written to" << f.fileName();
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class QWebEnginePage;
+class QWebEngineProfile;
+
+// cloudmusic-benchmark [--iterations=N]：在合成页面上把关键路径各测 N 次：
+//   startup_cold          新建 profile 与页面到首次 loadFinished
+//   startup_warm          同一页面重新加载到 loadFinished
+//   bridge_click_uncached 新文档中的第一次点击（遍历 Shadow DOM 解析按钮）
+//   bridge_click          元素缓存命中后的点击往返（与 PlayerCommandDispatcher 发送的脚本相同）
+//   bridge_state          __cmw.state() 往返
+//   state_write           StateStore::update() + flush()（QSaveFile 原子写入）
+// 结果（微秒）写入输出目录下的 benchmark.json 和 benchmark.csv，便于在不同 Qt/WebEngine 版本间比较。
+class Benchmark : public QObject {
+    Q_OBJECT
+
+public:
+    Benchmark(const QString &outputDir, int iterations, QObject *parent = nullptr)
+        : QObject(parent), m_outputDir(outputDir), m_iterations(iterations) {}
+
+    void start();
+
+    // --iterations=N，未指定时为 kDefaultIterations
+    static int iterationsFromArguments(const QStringList &args);
+
+signals:
+    void finished(bool ok);
+
+private:
+    static constexpr int kDefaultIterations = 20;
+    static constexpr int kShadowDepth = 12;
+    static constexpr int kNoisePerLevel = 50;
+
+    static QString fixtureHtml();
+    void loadFixture(QElapsedTimer timer, const std::function<void(qint64)> &done);
+    void warmLoads(int remaining);
+    void measureClick(const QString &name, const std::function<void()> &next);
+
+    // 依次执行 count 次 js，每次等上一次返回后再发送；返回 null 说明桥未注入，测试失败
+    void repeatJs(const QString &name, const QString &js, int count, const std::function<void()> &next);
+
+    void measureStateWrites();
+    void addSample(const QString &name, qint64 ns);
+    void fail(const QString &reason);
+    void finish();
+    bool writeFile(const QString &name, const QByteArray &data) const;
+
+    QString m_outputDir;
+    int m_iterations;
+    QWebEngineProfile *m_profile = nullptr;
+    QWebEnginePage *m_page = nullptr;
+    QStringList m_order;
+    QHash<QString, QList<double>> m_samples;
+};
@@ -0,0 +1,56 @@
+#include "cache_statistics.h"
+
+#include "cache_policy.h"
+#include "media_cache.h"
+#include "metrics.h"
+#include "player_bridge.h"
+
+#include <QApplication>
+#include <QMessageBox>
+#include <QPointer>
+#include <QThreadPool>
+#include <QVariantMap>
+#include <QWebEnginePage>
+#include <QWidget>
+
+void showCacheStatistics(QWidget *parent, QWebEnginePage *page, MediaCache *mediaCache, const QString &cachePath) {
+    QPointer<QWidget> parentGuard(parent);
+    runJavaScriptTimed(page, "resourceStats", QStringLiteral("window.__cmw ? __cmw.resourceStats() : null"),
+                       kBridgeWorldId, [=](const QVariant &v) {
+        const QVariantMap res = v.toMap();
+        const qint64 mediaHits = mediaCache ? mediaCache->hits() : 0;
+        const qint64 mediaMisses = mediaCache ? mediaCache->misses() : 0;
+        const qint64 mediaBytes = mediaCache ? mediaCache->totalBytes() : 0;
+        QThreadPool::globalInstance()->start([=]() {
+            const qint64 httpBytes = directorySize(cachePath);
+            QMetaObject::invokeMethod(qApp, [=]() {
+                const qint64 total = res.value("total").toLongLong();
+                const qint64 cached = res.value("cached").toLongLong();
+                const QString hitRate = total > 0 ? QString("%1%").arg(100.0 * cached / total, 0, 'f', 1) : "-";
+                const qint64 mediaTotal = mediaHits + mediaMisses;
+                const QString mediaRate = mediaTotal > 0 ? QString("%1%").arg(100.0 * mediaHits / mediaTotal, 0, 'f', 1) : "-";
+                const qint64 opaque = res.value("opaque").toLongLong();
+                const QString text = QString("HTTP 缓存（仅统计计时可见的资源）\n"
+                                             "  命中率：%1（%2 / %3 个资源）\n"
+                                             "  计时不可见、未计入：%10 个资源（跨域且未返回 Timing-Allow-Origin）\n"
+                                             "  本次加载下载：%4\n"
+                                             "  磁盘占用：%5\n\n"
+                                             "音频缓存\n"
+                                             "  命中率：%6（命中 %7，未命中 %8）\n"
+                                             "  磁盘占用：%9")
+                                         .arg(hitRate).arg(cached).arg(total)
+                                         .arg(formatBytes(res.value("transferred").toLongLong()))
+                                         .arg(formatBytes(httpBytes))
+                                         .arg(mediaRate).arg(mediaHits).arg(mediaMisses)
+                                         .arg(formatBytes(mediaBytes))
+                                         .arg(opaque);
+                // 非模态显示：不进入嵌套事件循环，页面推送的状态照常处理
+                QMessageBox *box = new QMessageBox(QMessageBox::Information, "缓存统计", text, QMessageBox::Ok,
+                                                   parentGuard);
+                box->setAttribute(Qt::WA_DeleteOnClose);
+                box->setModal(false);
+                box->show();
+            }, Qt::QueuedConnection);
+        });
+    });
+}
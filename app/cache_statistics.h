@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QString>
+
+class MediaCache;
+class QWebEnginePage;
+class QWidget;
+
+// 托盘菜单中的缓存统计：页面资源的 HTTP 缓存命中率（来自 Resource Timing，只覆盖计时可见的资源，
+// 计时不可见的跨域资源单独列出）、磁盘占用和音频缓存命中率。
+// 目录大小在线程池中计算，避免大缓存目录阻塞界面
+void showCacheStatistics(QWidget *parent, QWebEnginePage *page, MediaCache *mediaCache, const QString &cachePath);
@@ -0,0 +1,81 @@
+#include "main_window.h"
+
+#include <QApplication>
+#include <QCloseEvent>
+#include <QLabel>
+#include <QSettings>
+#include <QSystemTrayIcon>
+#include <QVBoxLayout>
+#include <QWebEngineView>
+
+MainWindow::MainWindow(QSystemTrayIcon *trayIcon, const QString &stateFilePath, QWidget *parent)
+    : QWidget(parent), m_trayIcon(trayIcon), m_stateFilePath(stateFilePath) {
+    QVBoxLayout *layout = new QVBoxLayout;
+
+    // 关键：去掉边距和间距，让 webview 铺满整个窗口
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(0);
+
+    // WebEngine 初始化完成前先显示轻量的占位界面
+    m_placeholder = new QLabel("正在加载播放器…");
+    m_placeholder->setAlignment(Qt::AlignCenter);
+    m_placeholder->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    layout->addWidget(m_placeholder);
+    setLayout(layout);
+    resize(1200, 800);
+    setWindowTitle("网易云音乐 Web 播放器");
+    loadSettings();
+}
+
+void MainWindow::setPlaceholderState(const QJsonObject &state) {
+    if (!m_placeholder || state.isEmpty()) return;
+    const int seconds = static_cast<int>(state.value("time").toDouble(0.0));
+    const QString title = state.value("title").toString();
+    m_placeholder->setText(QString("正在加载播放器…\n\n上次播放：%1  %2:%3")
+                               .arg(title.isEmpty() ? state.value("id").toString() : title)
+                               .arg(seconds / 60)
+                               .arg(seconds % 60, 2, 10, QLatin1Char('0')));
+}
+
+void MainWindow::setView(QWebEngineView *view) {
+    m_view = view;
+
+    // 确保 view 可以扩展填满布局
+    view->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    view->setContentsMargins(0, 0, 0, 0);
+
+    if (m_placeholder) {
+        delete layout()->replaceWidget(m_placeholder, view);
+        m_placeholder->deleteLater();
+        m_placeholder = nullptr;
+    } else {
+        layout()->addWidget(view);
+    }
+}
+
+void MainWindow::closeEvent(QCloseEvent *event) {
+    if (m_closeToTray) {
+        hide();
+        event->ignore();
+    } else {
+        saveSettings();
+        event->accept();
+        QApplication::quit();
+    }
+}
+
+void MainWindow::setCloseToTray(bool closeToTray) {
+    m_closeToTray = closeToTray;
+    saveSettings();
+}
+
+void MainWindow::loadSettings() {
+    QSettings settings(QApplication::organizationName(), QApplication::applicationName());
+    m_closeToTray = settings.value("closeToTray", true).toBool();
+}
+
+void MainWindow::saveSettings() {
+    QSettings settings(QApplication::organizationName(), QApplication::applicationName());
+    settings.setValue("closeToTray", m_closeToTray);
+}
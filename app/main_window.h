@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <QWidget>
+
+class QCloseEvent;
+class QLabel;
+class QSystemTrayIcon;
+class QWebEngineView;
+
+// 主窗口外壳：WebEngine 初始化前显示轻量的占位界面，之后放入播放页的 view。
+// 播放逻辑都在 PlayerController 中，这里只负责窗口与关闭行为。
+class MainWindow : public QWidget {
+    Q_OBJECT
+
+public:
+    MainWindow(QSystemTrayIcon *trayIcon, const QString &stateFilePath, QWidget *parent = nullptr);
+
+    // 在占位界面上显示上次保存的播放信息
+    void setPlaceholderState(const QJsonObject &state);
+
+    // WebEngine 就绪后用真正的 view 替换占位界面
+    void setView(QWebEngineView *view);
+
+    void closeEvent(QCloseEvent *event) override;
+
+    // 公共接口：读取/设置关闭到托盘行为
+    bool closeToTray() const { return m_closeToTray; }
+
+    void setCloseToTray(bool closeToTray);
+
+    void loadSettings();
+
+    void saveSettings();
+
+    QString stateFilePath() const { return m_stateFilePath; }
+
+private:
+    QWebEngineView *m_view = nullptr;
+    QLabel *m_placeholder = nullptr;
+    QSystemTrayIcon *m_trayIcon;
+    bool m_closeToTray = true;
+    QString m_stateFilePath;
+};
@@ -0,0 +1,131 @@
+#include "media_key_handler.h"
+
+#include "media_session.h"
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QKeyEvent>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+
+enum { kHotkeyPlayPause = 0xC301, kHotkeyNext, kHotkeyPrevious, kHotkeyStop };
+#endif
+
+MediaKeyHandler::MediaKeyHandler(MediaSession *session, QObject *parent)
+    : QObject(parent), m_session(session) {
+    m_clock.start();
+    qApp->installEventFilter(this);
+    qApp->installNativeEventFilter(this);
+    registerGlobalHotkeys();
+    connect(session, &MediaSession::playbackChanged, this, [this]() { reportStateChange(false); });
+    connect(session, &MediaSession::metadataChanged, this, [this]() { reportStateChange(true); });
+}
+
+MediaKeyHandler::~MediaKeyHandler() {
+    unregisterGlobalHotkeys();
+    // 不在这里调用 qApp->removeNativeEventFilter：处理器挂在 app 下，析构时 qApp 已经为空；
+    // ~QAbstractNativeEventFilter 会自行注销
+}
+
+bool MediaKeyHandler::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) {
+    Q_UNUSED(result);
+#if defined(Q_OS_WIN)
+    if (eventType == "windows_generic_MSG" || eventType == "windows_dispatcher_MSG") {
+        const MSG *msg = static_cast<const MSG *>(message);
+        if (msg->message == WM_HOTKEY) {
+            switch (msg->wParam) {
+                case kHotkeyPlayPause: handleKey(Key::PlayPause); return true;
+                case kHotkeyNext: handleKey(Key::Next); return true;
+                case kHotkeyPrevious: handleKey(Key::Previous); return true;
+                case kHotkeyStop: handleKey(Key::Stop); return true;
+                default: break;
+            }
+        }
+    }
+#else
+    Q_UNUSED(eventType);
+    Q_UNUSED(message);
+#endif
+    return false;
+}
+
+bool MediaKeyHandler::eventFilter(QObject *watched, QEvent *event) {
+    if (event->type() == QEvent::KeyPress) {
+        QKeyEvent *ke = static_cast<QKeyEvent *>(event);
+        Key key;
+        if (mapQtKey(ke->key(), &key)) {
+            if (!ke->isAutoRepeat()) handleKey(key);
+            return true;
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+bool MediaKeyHandler::mapQtKey(int qtKey, Key *key) {
+    switch (qtKey) {
+        case Qt::Key_MediaTogglePlayPause: *key = Key::PlayPause; return true;
+        case Qt::Key_MediaPlay: *key = Key::Play; return true;
+        case Qt::Key_MediaPause: *key = Key::Pause; return true;
+        case Qt::Key_MediaNext: *key = Key::Next; return true;
+        case Qt::Key_MediaPrevious: *key = Key::Previous; return true;
+        case Qt::Key_MediaStop: *key = Key::Stop; return true;
+        default: return false;
+    }
+}
+
+void MediaKeyHandler::handleKey(Key key) {
+    const qint64 pressedNs = m_clock.nsecsElapsed();
+    // 同一按键在去抖窗口内只处理一次（全局热键和窗口内按键可能同时到达）
+    if (key == m_lastKey && pressedNs - m_lastKeyNs < kDebounceMs * 1000000LL) return;
+    m_lastKey = key;
+    m_lastKeyNs = pressedNs;
+
+    switch (key) {
+        case Key::PlayPause: m_session->playPause(); break;
+        case Key::Play: m_session->play(); break;
+        case Key::Pause:
+        case Key::Stop: m_session->pause(); break;
+        case Key::Next: m_session->next(); break;
+        case Key::Previous: m_session->previous(); break;
+    }
+
+    const qint64 dispatchUs = (m_clock.nsecsElapsed() - pressedNs) / 1000;
+    Metrics::instance().addSample("media_key_dispatch_us", dispatchUs);
+    m_pendingNs = pressedNs;
+    m_pendingTrackChange = key == Key::Next || key == Key::Previous;
+}
+
+void MediaKeyHandler::reportStateChange(bool trackChanged) {
+    if (m_pendingNs < 0 || trackChanged != m_pendingTrackChange) return;
+    const qint64 latencyMs = (m_clock.nsecsElapsed() - m_pendingNs) / 1000000;
+    m_pendingNs = -1;
+    if (latencyMs > kStateTimeoutMs) return;
+    Metrics::instance().addSample("media_key_to_state", latencyMs);
+    qDebug().nospace() << "Media key to audio state change: " << latencyMs << " ms";
+}
+
+#if defined(Q_OS_WIN)
+void MediaKeyHandler::registerGlobalHotkeys() {
+    const struct { int id; UINT vk; } keys[] = {
+        {kHotkeyPlayPause, VK_MEDIA_PLAY_PAUSE},
+        {kHotkeyNext, VK_MEDIA_NEXT_TRACK},
+        {kHotkeyPrevious, VK_MEDIA_PREV_TRACK},
+        {kHotkeyStop, VK_MEDIA_STOP},
+    };
+    for (const auto &k : keys) {
+        // MOD_NOREPEAT：按住不放时不会重复触发
+        if (!RegisterHotKey(nullptr, k.id, MOD_NOREPEAT, k.vk))
+            qWarning() << "Failed to register media hotkey" << k.vk << "(already taken by another application?)";
+    }
+}
+
+void MediaKeyHandler::unregisterGlobalHotkeys() {
+    for (int id : {int(kHotkeyPlayPause), int(kHotkeyNext), int(kHotkeyPrevious), int(kHotkeyStop)})
+        UnregisterHotKey(nullptr, id);
+}
+#else
+void MediaKeyHandler::registerGlobalHotkeys() {}
+void MediaKeyHandler::unregisterGlobalHotkeys() {}
+#endif
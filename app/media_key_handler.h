@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QAbstractNativeEventFilter>
+#include <QElapsedTimer>
+#include <QObject>
+
+#include <limits>
+
+class MediaSession;
+
+// 媒体键处理：
+//   - 窗口获得焦点时：应用级事件过滤器接收 Qt::Key_Media* 按键（所有平台）；
+//   - 全局：Windows 上用 RegisterHotKey 注册媒体键，在原生事件过滤器中接收 WM_HOTKEY。
+//     Linux 桌面环境本身会占用媒体键并转发给 MPRIS，因此不再抓取 X11 按键。
+// 按键会去抖（忽略自动重复以及 kDebounceMs 内的重复按键），然后异步交给 MediaSession。
+// 从按键到入队的耗时、从按键到页面推送对应状态变化的耗时都会记录为指标并输出到日志。
+class MediaKeyHandler : public QObject, public QAbstractNativeEventFilter {
+    Q_OBJECT
+
+public:
+    explicit MediaKeyHandler(MediaSession *session, QObject *parent = nullptr);
+
+    ~MediaKeyHandler() override;
+
+    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) override;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    enum class Key { PlayPause, Play, Pause, Next, Previous, Stop };
+
+    static bool mapQtKey(int qtKey, Key *key);
+    void handleKey(Key key);
+    // 页面推送的状态发生了与按键对应的变化
+    void reportStateChange(bool trackChanged);
+    void registerGlobalHotkeys();
+    void unregisterGlobalHotkeys();
+
+    static constexpr qint64 kDebounceMs = 250;
+    static constexpr qint64 kStateTimeoutMs = 5000;
+
+    MediaSession *m_session;
+    QElapsedTimer m_clock;
+    Key m_lastKey = Key::Stop;
+    qint64 m_lastKeyNs = std::numeric_limits<qint64>::min() / 2;
+    qint64 m_pendingNs = -1;
+    bool m_pendingTrackChange = false;
+};
@@ -0,0 +1,260 @@
+#include "rendering_profile.h"
+
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSettings>
+// 定义 QT_FEATURE_opengl，QT_CONFIG(opengl) 需要它
+#include <QtGui/qtguiglobal.h>
+
+#if QT_CONFIG(opengl)
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#endif
+
+// 用户要求的配置（rendering/profile 或 --rendering），供探测判断是否需要运行
+static RenderingProfile activeProfile = RenderingProfile::Auto;
+// 本进程实际应用的配置（auto 已按探测结果解析）
+static RenderingProfile appliedProfile = RenderingProfile::Auto;
+
+// 探测用的离屏目标尺寸与绘制次数：全屏混合绘制，近似页面合成的填充开销
+static constexpr int kProbeSize = 1024;
+static constexpr int kProbeDraws = 50;
+// 低于该填充率（百万像素/秒）的 GPU 使用 low-power 配置
+static constexpr double kLowPowerFillRate = 1000.0;
+
+// 软件实现的 OpenGL：与其让 Chromium 走一遍 GPU 进程，不如直接使用软件合成
+static const char *const kSoftwareRenderers[] = {
+    "llvmpipe",
+    "softpipe",
+    "swiftshader",
+    "software rasterizer",
+    "microsoft basic render",
+    "gdi generic",
+};
+
+QString renderingProfileName(RenderingProfile profile) {
+    switch (profile) {
+    case RenderingProfile::Auto: return "auto";
+    case RenderingProfile::Gpu: return "gpu";
+    case RenderingProfile::Software: return "software";
+    case RenderingProfile::LowPower: return "low-power";
+    }
+    return "auto";
+}
+
+static bool renderingProfileFromName(const QString &name, RenderingProfile *profile) {
+    for (RenderingProfile p : {RenderingProfile::Auto, RenderingProfile::Gpu, RenderingProfile::Software,
+                               RenderingProfile::LowPower}) {
+        if (name.compare(renderingProfileName(p), Qt::CaseInsensitive) == 0) {
+            *profile = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+QStringList applyRenderingProfile(const QStringList &args) {
+    // Qt 尚未初始化，不能使用 QCoreApplication::organizationName()，与 applyChromiumFlags 一样使用固定名称
+    QSettings settings("CloudMusicWebPlayer-Qt", "CloudMusicWebPlayer-Qt");
+    QString name = settings.value("rendering/profile", "auto").toString();
+    const QString option = "--rendering=";
+    for (const QString &arg : args) {
+        if (arg.startsWith(option)) name = arg.mid(option.size());
+    }
+
+    RenderingProfile requested = RenderingProfile::Auto;
+    if (!renderingProfileFromName(name, &requested)) qWarning() << "Unknown rendering profile" << name << ", using auto";
+
+    RenderingProfile profile = requested;
+    if (profile == RenderingProfile::Auto) {
+        // 探测结果 "default" 或尚未探测：保持 Chromium 默认设置
+        RenderingProfile detected = RenderingProfile::Auto;
+        if (renderingProfileFromName(settings.value("rendering/detected").toString(), &detected)) profile = detected;
+    }
+    activeProfile = requested == RenderingProfile::Auto ? RenderingProfile::Auto : profile;
+    appliedProfile = profile;
+
+    QStringList flags;
+    switch (profile) {
+    case RenderingProfile::Auto:
+        break;
+    case RenderingProfile::Gpu:
+        flags << "--ignore-gpu-blocklist" << "--enable-gpu-rasterization";
+        break;
+    case RenderingProfile::Software:
+        QCoreApplication::setAttribute(Qt::AA_UseSoftwareOpenGL);
+        // 用户显式设置的 Qt Quick 后端优先
+        if (qEnvironmentVariableIsEmpty("QT_QUICK_BACKEND")) qputenv("QT_QUICK_BACKEND", "software");
+        flags << "--disable-gpu" << "--disable-gpu-compositing";
+        break;
+    case RenderingProfile::LowPower:
+#if defined(Q_OS_WIN)
+        // ANGLE（OpenGL ES 转 Direct3D）在集成显卡上的驱动兼容性通常好于桌面 OpenGL
+        QCoreApplication::setAttribute(Qt::AA_UseOpenGLES);
+#endif
+        flags << "--disable-gpu-rasterization" << "--num-raster-threads=1" << "--disable-smooth-scrolling";
+        break;
+    }
+
+    qInfo().noquote() << "Rendering profile:" << renderingProfileName(requested)
+                      << (requested == RenderingProfile::Auto && profile != RenderingProfile::Auto
+                              ? QString("(detected %1)").arg(renderingProfileName(profile))
+                              : QString());
+    return flags;
+}
+
+#if QT_CONFIG(opengl)
+static const char *kProbeVertexShader = R"GLSL(
+attribute vec2 position;
+void main() { gl_Position = vec4(position, 0.0, 1.0); }
+)GLSL";
+
+static const char *kProbeFragmentShader = R"GLSL(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform float alpha;
+void main() { gl_FragColor = vec4(0.2, 0.4, 0.6, alpha); }
+)GLSL";
+
+static GLuint compileProbeShader(QOpenGLFunctions *gl, GLenum type, const char *source) {
+    const GLuint shader = gl->glCreateShader(type);
+    gl->glShaderSource(shader, 1, &source, nullptr);
+    gl->glCompileShader(shader);
+    GLint ok = 0;
+    gl->glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        gl->glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// 在离屏纹理上做 kProbeDraws 次全屏半透明绘制，返回填充率（百万像素/秒），失败返回 -1
+static double measureFillRate(QOpenGLFunctions *gl) {
+    GLuint texture = 0;
+    GLuint fbo = 0;
+    gl->glGenTextures(1, &texture);
+    gl->glBindTexture(GL_TEXTURE_2D, texture);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, kProbeSize, kProbeSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl->glGenFramebuffers(1, &fbo);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+
+    double fillRate = -1;
+    const GLuint vertexShader = compileProbeShader(gl, GL_VERTEX_SHADER, kProbeVertexShader);
+    const GLuint fragmentShader = compileProbeShader(gl, GL_FRAGMENT_SHADER, kProbeFragmentShader);
+    const GLuint program = gl->glCreateProgram();
+    if (gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE && vertexShader && fragmentShader) {
+        gl->glAttachShader(program, vertexShader);
+        gl->glAttachShader(program, fragmentShader);
+        gl->glBindAttribLocation(program, 0, "position");
+        gl->glLinkProgram(program);
+        GLint linked = 0;
+        gl->glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked) {
+            static const GLfloat quad[] = {-1, -1, 1, -1, -1, 1, 1, 1};
+            gl->glUseProgram(program);
+            gl->glViewport(0, 0, kProbeSize, kProbeSize);
+            gl->glEnable(GL_BLEND);
+            gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            gl->glEnableVertexAttribArray(0);
+            gl->glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, quad);
+            const GLint alpha = gl->glGetUniformLocation(program, "alpha");
+
+            // 第一次绘制包含驱动的延迟初始化，不计入
+            gl->glUniform1f(alpha, 0.5f);
+            gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            gl->glFinish();
+
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < kProbeDraws; ++i) {
+                gl->glUniform1f(alpha, 0.1f + 0.8f * float(i) / kProbeDraws);
+                gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+            gl->glFinish();
+            const qint64 elapsedUs = qMax<qint64>(timer.nsecsElapsed() / 1000, 1);
+            fillRate = double(kProbeSize) * kProbeSize * kProbeDraws / elapsedUs;
+            gl->glDisableVertexAttribArray(0);
+            gl->glDisable(GL_BLEND);
+        }
+    }
+
+    gl->glDeleteProgram(program);
+    if (vertexShader) gl->glDeleteShader(vertexShader);
+    if (fragmentShader) gl->glDeleteShader(fragmentShader);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl->glDeleteFramebuffers(1, &fbo);
+    gl->glDeleteTextures(1, &texture);
+    return fillRate;
+}
+#endif
+
+// 返回探测结论（"default"、"software" 或 "low-power"），并通过参数带回渲染器名称与填充率
+static QString detectRenderingProfile(QString *renderer, double *fillRate) {
+#if QT_CONFIG(opengl)
+    QOpenGLContext context;
+    if (!context.create()) return renderingProfileName(RenderingProfile::Software);
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!surface.isValid() || !context.makeCurrent(&surface)) return renderingProfileName(RenderingProfile::Software);
+
+    QOpenGLFunctions *gl = context.functions();
+    *renderer = QString::fromLatin1(reinterpret_cast<const char *>(gl->glGetString(GL_RENDERER)));
+    const QString lowerRenderer = renderer->toLower();
+    for (const char *name : kSoftwareRenderers) {
+        if (lowerRenderer.contains(QLatin1String(name))) {
+            context.doneCurrent();
+            return renderingProfileName(RenderingProfile::Software);
+        }
+    }
+
+    *fillRate = measureFillRate(gl);
+    context.doneCurrent();
+    if (*fillRate < 0) return renderingProfileName(RenderingProfile::Software);
+    if (*fillRate < kLowPowerFillRate) return renderingProfileName(RenderingProfile::LowPower);
+    return "default";
+#else
+    Q_UNUSED(renderer);
+    Q_UNUSED(fillRate);
+    return renderingProfileName(RenderingProfile::Software);
+#endif
+}
+
+void probeRenderingIfNeeded() {
+    if (activeProfile != RenderingProfile::Auto) return;
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    // Qt 版本变化可能带来不同的 Chromium 与驱动处理方式，重新探测
+    const QString qtVersion = QString::fromLatin1(qVersion());
+    if (settings.contains("rendering/detected") && settings.value("rendering/probeQtVersion").toString() == qtVersion)
+        return;
+    // 本进程已按上次结果设置了 AA_UseSoftwareOpenGL / AA_UseOpenGLES 等，此时探测只会测到被指定的实现
+    // （software 会一直确认自己）。清除结果，下次以默认设置启动时再探测
+    if (appliedProfile != RenderingProfile::Auto) {
+        settings.remove("rendering/detected");
+        settings.remove("rendering/probeQtVersion");
+        qInfo().noquote() << "Qt version changed, dropping detected rendering profile"
+                          << renderingProfileName(appliedProfile) << "and probing on next start";
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QString renderer;
+    double fillRate = -1;
+    const QString detected = detectRenderingProfile(&renderer, &fillRate);
+    Metrics::instance().addSample("rendering_probe", timer.elapsed());
+
+    settings.setValue("rendering/detected", detected);
+    settings.setValue("rendering/probeQtVersion", qtVersion);
+    settings.setValue("rendering/probeRenderer", renderer);
+    settings.setValue("rendering/probeFillRate", qRound(fillRate));
+    qInfo().nospace() << "Rendering probe: " << detected << " (renderer " << renderer << ", "
+                      << qRound(fillRate) << " Mpx/s, " << timer.elapsed() << " ms), applied on next start";
+}
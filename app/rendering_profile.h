@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+// 启动时的渲染配置，设置键 rendering/profile，命令行 --rendering=<name> 优先：
+//   auto       默认。使用上次探测的结果（rendering/detected），尚未探测时使用 Chromium 默认设置
+//   gpu        强制 GPU 合成与光栅化，忽略 Chromium 的 GPU 黑名单
+//   software   关闭 GPU 进程，Qt Quick 使用软件渲染（虚拟机、驱动不稳定的机器）
+//   low-power  保留 GPU 合成，但关闭 GPU 光栅化并减少光栅线程（性能较弱的集成显卡）
+enum class RenderingProfile {
+    Auto,
+    Gpu,
+    Software,
+    LowPower,
+};
+
+QString renderingProfileName(RenderingProfile profile);
+
+// 在 QApplication 构造前调用：确定渲染配置，设置 Qt 应用属性与环境变量，
+// 返回需要追加到 QTWEBENGINE_CHROMIUM_FLAGS 的参数
+QStringList applyRenderingProfile(const QStringList &args);
+
+// auto 配置下，若尚未探测过（或 Qt 版本变化），用离屏 OpenGL 上下文做一次简短的填充测试，
+// 把结论写入 rendering/detected，下次启动生效。需要在 QGuiApplication 构造后调用
+void probeRenderingIfNeeded();
@@ -0,0 +1,85 @@
+#include "tray_mode_controller.h"
+
+#include "process_stats.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QWidget>
+
+TrayModeController::TrayModeController(QWebEnginePage *page, QWidget *window, QObject *parent)
+    : QObject(parent), m_page(page), m_window(window) {
+    m_freezeTimer.setSingleShot(true);
+    m_freezeTimer.setInterval(60000);
+    connect(&m_freezeTimer, &QTimer::timeout, this, &TrayModeController::freezeIfSilent);
+    connect(page, &QWebEnginePage::recentlyAudibleChanged, this, [this](bool audible) {
+        if (!m_trayMode) return;
+        if (audible) {
+            m_freezeTimer.stop();
+            setLifecycle(QWebEnginePage::LifecycleState::Active);
+        } else {
+            m_freezeTimer.start();
+        }
+    });
+    // 托盘命令等操作会临时唤醒页面，此时重新开始计时
+    connect(page, &QWebEnginePage::lifecycleStateChanged, this, [this](QWebEnginePage::LifecycleState state) {
+        if (m_trayMode && state == QWebEnginePage::LifecycleState::Active && !m_page->recentlyAudible())
+            m_freezeTimer.start();
+    });
+    window->installEventFilter(this);
+    m_trayMode = !window->isVisible();
+    startSample();
+}
+
+bool TrayModeController::eventFilter(QObject *watched, QEvent *event) {
+    if (watched == m_window) {
+        if (event->type() == QEvent::Show) setTrayMode(false);
+        else if (event->type() == QEvent::Hide) setTrayMode(true);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void TrayModeController::setTrayMode(bool trayMode) {
+    if (m_trayMode == trayMode) return;
+    logSample();
+    m_trayMode = trayMode;
+    if (trayMode) {
+        if (!m_page->recentlyAudible()) m_freezeTimer.start();
+    } else {
+        m_freezeTimer.stop();
+        setLifecycle(QWebEnginePage::LifecycleState::Active);
+    }
+    startSample();
+}
+
+void TrayModeController::freezeIfSilent() {
+    // 页面可见时不能冻结
+    if (!m_trayMode || m_page->recentlyAudible() || m_page->isVisible()) return;
+    setLifecycle(QWebEnginePage::LifecycleState::Frozen);
+}
+
+void TrayModeController::setLifecycle(QWebEnginePage::LifecycleState state) {
+    if (m_page->lifecycleState() != state) m_page->setLifecycleState(state);
+}
+
+qint64 TrayModeController::cpuTimeMs() const {
+    const qint64 self = processCpuTimeMs(QCoreApplication::applicationPid());
+    const qint64 renderer = processCpuTimeMs(m_page->renderProcessPid());
+    if (self < 0) return -1;
+    return self + qMax<qint64>(renderer, 0);
+}
+
+void TrayModeController::startSample() {
+    m_sampleTimer.start();
+    m_sampleCpuMs = cpuTimeMs();
+}
+
+void TrayModeController::logSample() const {
+    const qint64 wallMs = m_sampleTimer.elapsed();
+    const qint64 cpuMs = cpuTimeMs();
+    if (wallMs <= 0 || cpuMs < 0 || m_sampleCpuMs < 0) return;
+    const qint64 used = cpuMs - m_sampleCpuMs;
+    qDebug().nospace() << (m_trayMode ? "Tray mode" : "Window mode") << " lasted " << wallMs / 1000
+                       << " s, CPU " << used << " ms (" << QString::number(100.0 * used / wallMs, 'f', 2)
+                       << "%)";
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QWebEnginePage>
+
+class QWidget;
+
+// 托盘模式：主窗口隐藏后，QWebEngineView 不可见，Chromium 会停止合成与绘制；
+// 如果页面一段时间内没有声音（暂停或停止），再把页面冻结（LifecycleState::Frozen），暂停页面定时器等任务。
+// 正在播放时保持 Active，保证音频与切歌逻辑不受影响。窗口重新显示时立即恢复为 Active。
+// 每次切换模式时在日志中输出上一阶段主进程 + 渲染进程的 CPU 占用，便于对比前后差异。
+class TrayModeController : public QObject {
+    Q_OBJECT
+
+public:
+    TrayModeController(QWebEnginePage *page, QWidget *window, QObject *parent = nullptr);
+
+    bool isTrayMode() const { return m_trayMode; }
+
+    // 页面静音多久后冻结
+    void setFreezeDelay(int delayMs) { m_freezeTimer.setInterval(delayMs); }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void setTrayMode(bool trayMode);
+    void freezeIfSilent();
+    void setLifecycle(QWebEnginePage::LifecycleState state);
+    qint64 cpuTimeMs() const;
+    void startSample();
+    void logSample() const;
+
+    QWebEnginePage *m_page;
+    QWidget *m_window;
+    bool m_trayMode = false;
+    QTimer m_freezeTimer;
+    QElapsedTimer m_sampleTimer;
+    qint64 m_sampleCpuMs = -1;
+};
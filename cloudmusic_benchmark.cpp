@@ -0,0 +1,37 @@
+// cloudmusic-benchmark：在本地合成页面上测量媒体控制桥、页面加载和状态落盘的耗时（见 app/benchmark.h）。
+// 独立于播放器：不连接已运行的实例，不加载播放页，也不读写播放器的 profile。
+//
+// 用法：cloudmusic-benchmark [--iterations=N] [--trace=<文件>]
+
+#include <QDir>
+#include <QGuiApplication>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include "benchmark.h"
+#include "trace_recorder.h"
+
+int main(int argc, char *argv[]) {
+    // 合成页面不挂到视图上，不需要显示服务器
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // WebEngine 需要 QGuiApplication；组织名/应用名与主程序相同，结果写入播放器的数据目录
+    QGuiApplication app(argc, argv);
+    app.setOrganizationName("CloudMusicWebPlayer-Qt");
+    app.setApplicationName("CloudMusicWebPlayer-Qt");
+
+    const QString outputDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(outputDir);
+
+    for (const QString &arg : app.arguments()) {
+        if (arg.startsWith("--trace=")) TraceRecorder::instance().start(arg.mid(int(qstrlen("--trace="))));
+    }
+
+    Benchmark *benchmark = new Benchmark(outputDir, Benchmark::iterationsFromArguments(app.arguments()), &app);
+    QObject::connect(benchmark, &Benchmark::finished, &app, [&app](bool ok) { app.exit(ok ? 0 : 1); });
+    QTimer::singleShot(0, benchmark, &Benchmark::start);
+
+    const int ret = app.exec();
+    TraceRecorder::instance().stop();
+    return ret;
+}
@@ -0,0 +1,21 @@
+// cloudmusic-ctl：供脚本、状态栏等频繁调用的轻量控制客户端。
+// 只链接 QtCore 和 QtNetwork，不加载 GUI 平台插件和 WebEngine，启动开销只有连接本地 socket 的时间。
+//
+// 用法：cloudmusic-ctl --play-pause | --play | --pause | --next | --prev | --seek <秒> | --status
+
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include "ipc_protocol.h"
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    RemoteCommand command;
+    if (!parseRemoteCommand(app.arguments(), &command)) {
+        QTextStream(stderr) << "Usage: cloudmusic-ctl --play-pause | --play | --pause | --next | --prev"
+                               " | --seek <seconds> | --status\n";
+        return 2;
+    }
+    return runRemoteCommand(command);
+}
@@ -0,0 +1,57 @@
+#include "cache_policy.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSettings>
+#include <QWebEngineProfile>
+
+#include <limits>
+
+// int 能表示的最大整 MB 数
+static constexpr int kMaxHttpCacheMB = std::numeric_limits<int>::max() / (1024 * 1024);
+
+void applyHttpCachePolicy(QWebEngineProfile *profile, const QString &cachePath) {
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    const QString type = settings.value("cache/type", "disk").toString();
+    const int maxSizeMB = settings.value("cache/maxSizeMB", 200).toInt();
+
+    profile->setCachePath(cachePath);
+    if (type == "memory") {
+        profile->setHttpCacheType(QWebEngineProfile::MemoryHttpCache);
+    } else if (type == "none") {
+        profile->setHttpCacheType(QWebEngineProfile::NoCache);
+    } else {
+        profile->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
+        // setHttpCacheMaximumSize 接受 int 字节数，上限约 2 GB，超出时按上限处理
+        qint64 maxBytes = qint64(qMax(0, maxSizeMB)) * 1024 * 1024;
+        if (maxBytes > std::numeric_limits<int>::max()) {
+            qWarning() << "cache/maxSizeMB" << maxSizeMB << "exceeds the supported maximum, using" << kMaxHttpCacheMB;
+            maxBytes = qint64(kMaxHttpCacheMB) * 1024 * 1024;
+        }
+        profile->setHttpCacheMaximumSize(int(maxBytes));
+    }
+
+    if (settings.value("cache/pruneOnStartup", false).toBool()) {
+        profile->clearHttpCache();
+        qDebug() << "HTTP cache cleared on startup";
+    }
+}
+
+qint64 directorySize(const QString &path) {
+    qint64 total = 0;
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        total += it.fileInfo().size();
+    }
+    return total;
+}
+
+QString formatBytes(qint64 bytes) {
+    if (bytes >= 1024 * 1024) return QString("%1 MB").arg(bytes / 1024.0 / 1024.0, 0, 'f', 1);
+    if (bytes >= 1024) return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    return QString("%1 B").arg(bytes);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QString>
+
+class QWebEngineProfile;
+
+// 从 QSettings 读取 HTTP 缓存策略并应用到 profile：
+//   cache/type            disk（默认）/ memory / none
+//   cache/maxSizeMB       磁盘缓存上限，默认 200；0 表示由 Chromium 自行决定；最大 2047
+//   cache/pruneOnStartup  启动时清空 HTTP 缓存，默认 false
+void applyHttpCachePolicy(QWebEngineProfile *profile, const QString &cachePath);
+
+// 递归统计目录占用的字节数
+qint64 directorySize(const QString &path);
+
+QString formatBytes(qint64 bytes);
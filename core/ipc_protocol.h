@@ -0,0 +1,149 @@
+#pragma once
+
+// 单实例 IPC 协议与命令行客户端。只依赖 QtCore 和 QtNetwork，
+// 由主程序和轻量的 cloudmusic-ctl 共用。
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QLocalSocket>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QtEndian>
+
+// 单实例 socket 上的协议（版本 kIpcProtocolVersion）：
+//   - 帧：QDataStream（Qt_5_15）序列化的 QByteArray，即 4 字节长度 + 内容，与旧版 "activate" 消息兼容；
+//   - 请求：JSON {"v":1, "id":N, "cmd":"play|pause|playPause|next|prev|seek|status|subscribe|activate", "value":秒}
+//   - 应答：JSON {"v":1, "id":N, "ok":bool, "error":"...", "latencyMs":N, "state":{...}}
+//   - 通知：subscribe 之后，状态变化时推送 {"v":1, "event":"state", "state":{...}}
+// 连接是持久的，同一连接上可以连续发送多条请求（流水线），应答按完成顺序返回并带有请求的 id。
+static constexpr int kIpcProtocolVersion = 1;
+
+// 单帧内容的上限。请求和状态应答都只有几百字节，超过上限的帧（或损坏的长度头）不再缓冲等待
+static constexpr quint32 kIpcMaxFrameBytes = 64 * 1024;
+
+// 单实例 socket 名称。组织名/应用名固定，不依赖 QCoreApplication 的设置，
+// 这样 cloudmusic-ctl 不需要知道主程序的 applicationName
+inline QString ipcServerName() {
+    return QString("CloudMusicWebPlayer-Qt-%1-single-instance")
+        .arg(qgetenv("CloudMusicWebPlayer-Qt")); // 可根据需要改为更唯一的标识
+}
+
+// 判断是否可能已有实例在运行：Unix 上本地 socket 对应临时目录下的文件，文件不存在时无需探测。
+// Windows 命名管道无法廉价判断，总是返回 true。
+inline bool singleInstanceMayBeRunning(const QString &serverName) {
+#if defined(Q_OS_UNIX)
+    return QFile::exists(QDir(QDir::tempPath()).filePath(serverName));
+#else
+    Q_UNUSED(serverName);
+    return true;
+#endif
+}
+
+inline void writeIpcFrame(QIODevice *device, const QByteArray &payload) {
+    QDataStream out(device);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << payload;
+}
+
+inline void writeIpcMessage(QIODevice *device, QJsonObject message) {
+    message["v"] = kIpcProtocolVersion;
+    writeIpcFrame(device, QJsonDocument(message).toJson(QJsonDocument::Compact));
+}
+
+// 从 device 中读出所有完整的帧，不完整的帧留待下次数据到达。
+// 遇到长度超过 kIpcMaxFrameBytes 的帧时停止读取并把 *oversize 置为 true，调用方应断开连接
+inline QList<QByteArray> readIpcFrames(QIODevice *device, bool *oversize = nullptr) {
+    QList<QByteArray> frames;
+    QDataStream in(device);
+    in.setVersion(QDataStream::Qt_5_15);
+    if (oversize) *oversize = false;
+    for (;;) {
+        // 先看长度头，避免为一个巨大的帧一直缓冲数据（0xFFFFFFFF 表示空 QByteArray）
+        const QByteArray header = device->peek(sizeof(quint32));
+        if (header.size() < int(sizeof(quint32))) break;
+        const quint32 length = qFromBigEndian<quint32>(header.constData());
+        if (length != 0xFFFFFFFFu && length > kIpcMaxFrameBytes) {
+            if (oversize) *oversize = true;
+            break;
+        }
+        in.startTransaction();
+        QByteArray frame;
+        in >> frame;
+        if (!in.commitTransaction()) break;
+        frames.append(frame);
+    }
+    return frames;
+}
+
+// 命令行控制参数，例如 --next、--seek 90、--status
+struct RemoteCommand {
+    QString cmd;
+    double value = 0.0;
+    // --seek 后面缺少参数或不是数字时不发送 value，由服务端拒绝
+    bool hasValue = false;
+};
+
+inline bool parseRemoteCommand(const QStringList &args, RemoteCommand *out) {
+    static const QHash<QString, QString> flags = {
+        {"--play", "play"},
+        {"--pause", "pause"},
+        {"--play-pause", "playPause"},
+        {"--next", "next"},
+        {"--prev", "prev"},
+        {"--seek", "seek"},
+        {"--status", "status"},
+    };
+    for (int i = 1; i < args.size(); ++i) {
+        auto it = flags.constFind(args.at(i));
+        if (it == flags.constEnd()) continue;
+        out->cmd = it.value();
+        if (out->cmd == "seek") out->value = args.value(i + 1).toDouble(&out->hasValue);
+        return true;
+    }
+    return false;
+}
+
+// 通过已连接的 socket 向运行中的实例发送一条命令并等待应答，打印结果。返回进程退出码
+inline int sendRemoteCommand(QLocalSocket *socket, const RemoteCommand &command, int timeoutMs = 3000) {
+    QJsonObject request;
+    request["id"] = 1;
+    request["cmd"] = command.cmd;
+    if (command.hasValue) request["value"] = command.value;
+    writeIpcMessage(socket, request);
+    socket->flush();
+
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < timeoutMs) {
+        if (!socket->waitForReadyRead(int(timeoutMs - timer.elapsed()))) break;
+        for (const QByteArray &frame : readIpcFrames(socket)) {
+            const QJsonObject reply = QJsonDocument::fromJson(frame).object();
+            if (reply.value("id").toInt() != 1) continue;
+            QTextStream(stdout) << QString::fromUtf8(QJsonDocument(reply).toJson(QJsonDocument::Compact)) << "\n";
+            return reply.value("ok").toBool() ? 0 : 1;
+        }
+    }
+    QTextStream(stderr) << "No reply from running instance\n";
+    return 1;
+}
+
+// 连接运行中的实例并执行命令；没有运行实例时返回 1。只需要 QCoreApplication
+inline int runRemoteCommand(const RemoteCommand &command) {
+    const QString serverName = ipcServerName();
+    if (singleInstanceMayBeRunning(serverName)) {
+        QLocalSocket socket;
+        socket.connectToServer(serverName, QIODevice::ReadWrite);
+        if (socket.waitForConnected(200)) return sendRemoteCommand(&socket, command);
+    }
+    QTextStream(stderr) << "No running instance\n";
+    return 1;
+}
@@ -0,0 +1,182 @@
+#include "ipc_server.h"
+
+#include "ipc_protocol.h"
+#include "media_session.h"
+#include "metrics.h"
+#include "player_command.h"
+#include "player_controller.h"
+#include "trace_recorder.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QPointer>
+
+#include <utility>
+
+IpcServer::IpcServer(QObject *parent) : QObject(parent) {
+    connect(&m_server, &QLocalServer::newConnection, this, &IpcServer::acceptConnections);
+}
+
+bool IpcServer::listen(const QString &serverName) {
+    // 先移除可能残留的 socket 文件，避免 listen 失败
+    QLocalServer::removeServer(serverName);
+    if (!m_server.listen(serverName)) {
+        qWarning() << "Failed to listen on local server:" << m_server.errorString();
+        return false;
+    }
+    return true;
+}
+
+void IpcServer::close() {
+    if (!m_server.isListening()) return;
+    const QString name = m_server.serverName();
+    m_server.close();
+    // removeServer 以清理 socket 文件
+    QLocalServer::removeServer(name);
+}
+
+void IpcServer::setPlayer(PlayerController *player) {
+    m_player = player;
+    MediaSession *session = player->session();
+    connect(session, &MediaSession::metadataChanged, this, &IpcServer::notifySubscribers);
+    connect(session, &MediaSession::playbackChanged, this, &IpcServer::notifySubscribers);
+    connect(session, &MediaSession::seeked, this, &IpcServer::notifySubscribers);
+}
+
+void IpcServer::acceptConnections() {
+    while (QLocalSocket *client = m_server.nextPendingConnection()) {
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() {
+            bool oversize = false;
+            const QList<QByteArray> frames = readIpcFrames(client, &oversize);
+            for (const QByteArray &frame : frames) handleFrame(client, frame);
+            if (oversize) {
+                // 长度头已经不可信，之后的数据无法再对齐到帧边界，只能断开
+                qWarning() << "IPC frame exceeds" << kIpcMaxFrameBytes << "bytes, disconnecting client";
+                Metrics::instance().increment("ipc_rejected_clients");
+                client->abort();
+            }
+        });
+        connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+            m_subscribers.removeAll(client);
+            client->deleteLater();
+        });
+    }
+}
+
+void IpcServer::handleFrame(QLocalSocket *client, const QByteArray &frame) {
+    Metrics::instance().increment("ipc_messages");
+    TraceRecorder::instance().instant("ipc", "ipc.receive", frame.size());
+    // 旧版协议：裸的 "activate"
+    if (frame == "activate") {
+        emit activateRequested();
+        return;
+    }
+
+    QJsonParseError err;
+    const QJsonObject request = QJsonDocument::fromJson(frame, &err).object();
+    QJsonObject reply;
+    reply["id"] = request.value("id");
+    if (err.error != QJsonParseError::NoError) {
+        reply["ok"] = false;
+        reply["error"] = "malformed request";
+        writeIpcMessage(client, reply);
+        return;
+    }
+    if (request.value("v").toInt(kIpcProtocolVersion) > kIpcProtocolVersion) {
+        reply["ok"] = false;
+        reply["error"] = "unsupported protocol version";
+        writeIpcMessage(client, reply);
+        return;
+    }
+
+    const QString cmd = request.value("cmd").toString();
+    if (cmd == "activate") {
+        emit activateRequested();
+        reply["ok"] = true;
+        writeIpcMessage(client, reply);
+        return;
+    }
+    if (!m_player) {
+        reply["ok"] = false;
+        reply["error"] = "player not ready";
+        writeIpcMessage(client, reply);
+        return;
+    }
+    if (cmd == "status") {
+        reply["ok"] = true;
+        reply["state"] = sessionState();
+        writeIpcMessage(client, reply);
+        return;
+    }
+    if (cmd == "subscribe") {
+        if (!m_subscribers.contains(client)) m_subscribers.append(client);
+        reply["ok"] = true;
+        reply["state"] = sessionState();
+        writeIpcMessage(client, reply);
+        return;
+    }
+
+    PlayerCommand command;
+    if (!playerCommandFromKey(cmd, &command)) {
+        reply["ok"] = false;
+        reply["error"] = "unknown command: " + cmd;
+        writeIpcMessage(client, reply);
+        return;
+    }
+    // 带参数的命令必须给出数值参数；缺少或不是数字时拒绝，不能当作 0（例如跳到开头）执行
+    const QJsonValue value = request.value("value");
+    if (playerCommandHasValue(command) && !value.isDouble()) {
+        reply["ok"] = false;
+        reply["error"] = cmd + " requires a numeric value";
+        writeIpcMessage(client, reply);
+        return;
+    }
+    // 命令异步完成后再应答；客户端可能已断开
+    QPointer<QLocalSocket> guard(client);
+    TraceRecorder &trace = TraceRecorder::instance();
+    const quint64 traceId = trace.isEnabled() ? trace.nextId() : 0;
+    if (traceId) trace.asyncBegin("ipc", "ipc." + cmd, traceId);
+    m_player->dispatcher()->dispatch(command, value.toDouble(), [guard, reply, cmd, traceId](bool ok, qint64 latencyMs) {
+        if (traceId) TraceRecorder::instance().asyncEnd("ipc", "ipc." + cmd, traceId, ok ? 1 : 0);
+        if (!guard || guard->state() != QLocalSocket::ConnectedState) return;
+        QJsonObject r = reply;
+        r["ok"] = ok;
+        r["latencyMs"] = latencyMs;
+        writeIpcMessage(guard, r);
+    });
+}
+
+QJsonObject IpcServer::sessionState() const {
+    const MediaSession *session = m_player->session();
+    QJsonObject state;
+    state["id"] = session->trackId();
+    state["title"] = session->title();
+    state["artist"] = session->artist();
+    state["album"] = session->album();
+    state["duration"] = session->duration();
+    state["position"] = session->position();
+    state["playing"] = session->isPlaying();
+    return state;
+}
+
+void IpcServer::notifySubscribers() {
+    if (m_subscribers.isEmpty()) return;
+    QJsonObject event;
+    event["event"] = "state";
+    event["state"] = sessionState();
+    TraceRecorder::instance().instant("ipc", "ipc.notify", m_subscribers.size());
+    // abort() 会同步触发 disconnected 并修改 m_subscribers，遍历副本
+    const QList<QLocalSocket *> subscribers = m_subscribers;
+    for (QLocalSocket *client : subscribers) {
+        // 订阅者不读取通知时，写缓冲会无限增长；积压超过上限就断开它
+        if (client->bytesToWrite() > kMaxSubscriberBacklog) {
+            qWarning() << "IPC subscriber not reading notifications, disconnecting";
+            Metrics::instance().increment("ipc_dropped_subscribers");
+            m_subscribers.removeAll(client);
+            client->abort();
+            continue;
+        }
+        writeIpcMessage(client, event);
+    }
+}
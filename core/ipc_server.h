@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QList>
+#include <QLocalServer>
+#include <QObject>
+#include <QString>
+
+class PlayerController;
+class QLocalSocket;
+
+// 单实例 socket 的服务端，协议见 ipc_protocol.h。
+// 先 listen() 占住单实例名，播放器就绪后再 setPlayer()；此前收到的播放命令回复 "player not ready"。
+class IpcServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit IpcServer(QObject *parent = nullptr);
+
+    bool listen(const QString &serverName);
+
+    void close();
+
+    void setPlayer(PlayerController *player);
+
+signals:
+    void activateRequested();
+
+private:
+    void acceptConnections();
+    void handleFrame(QLocalSocket *client, const QByteArray &frame);
+    QJsonObject sessionState() const;
+    void notifySubscribers();
+
+    // 订阅者写缓冲中积压超过这么多字节（约上千条通知）时断开
+    static constexpr qint64 kMaxSubscriberBacklog = 256 * 1024;
+
+    QLocalServer m_server;
+    PlayerController *m_player = nullptr;
+    QList<QLocalSocket *> m_subscribers;
+};
@@ -0,0 +1,264 @@
+#include "media_cache.h"
+
+#include "metrics.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QWebEngineUrlRequestInfo>
+#include <QWebEngineUrlRequestJob>
+#include <QWebEngineUrlScheme>
+
+#include <limits>
+#include <utility>
+
+MediaCache::MediaCache(const QString &dir, qint64 maxBytes, QObject *parent)
+    : QObject(parent), m_dir(dir), m_maxBytes(maxBytes) {
+    QDir().mkpath(m_dir);
+    loadIndex();
+}
+
+QString MediaCache::keyForUrl(const QUrl &url) {
+    const QString key = url.fileName();
+    return isValidKey(key) ? key : QString();
+}
+
+bool MediaCache::isValidKey(const QString &key) {
+    static const QRegularExpression pattern(QStringLiteral("^[A-Za-z0-9_-]{1,128}\\.[A-Za-z0-9]{1,8}$"));
+    return pattern.match(key).hasMatch();
+}
+
+QString MediaCache::lookup(const QString &key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end() || it->size <= 0) return QString();
+    const QString path = QDir(m_dir).filePath(key);
+    if (!QFile::exists(path)) {
+        m_totalBytes -= it->size;
+        it->size = 0;
+        return QString();
+    }
+    it->lastAccess = QDateTime::currentSecsSinceEpoch();
+    return path;
+}
+
+QString MediaCache::filePath(const QString &key) const {
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd() || it->size <= 0) return QString();
+    return QDir(m_dir).filePath(key);
+}
+
+void MediaCache::notePlay(const QUrl &url, const QByteArray &range) {
+    const QString key = keyForUrl(url);
+    if (key.isEmpty()) return;
+    if (!range.isEmpty()) {
+        if (!range.startsWith("bytes=0-")) return;
+    } else if (key == m_lastKey) {
+        return;
+    }
+    m_lastKey = key;
+    emit playStarted(url);
+    Entry &e = m_entries[key];
+    e.plays++;
+    e.lastAccess = QDateTime::currentSecsSinceEpoch();
+    if (e.size <= 0 && !e.oversize && e.plays >= m_minPlays) download(key, url);
+    pruneUncached();
+}
+
+void MediaCache::recordHit(const QString &key) {
+    m_lastKey = key;
+    m_hits++;
+    Metrics::instance().increment("media_cache_hits");
+}
+
+void MediaCache::recordMiss() {
+    m_misses++;
+    Metrics::instance().increment("media_cache_misses");
+}
+
+void MediaCache::saveIndex() const {
+    QJsonObject entries;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        QJsonObject o;
+        o["size"] = it->size;
+        o["last_access"] = it->lastAccess;
+        o["plays"] = it->plays;
+        if (it->oversize) o["oversize"] = true;
+        entries.insert(it.key(), o);
+    }
+    QSaveFile f(QDir(m_dir).filePath("index.json"));
+    if (!f.open(QIODevice::WriteOnly)) return;
+    f.write(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+    f.commit();
+}
+
+void MediaCache::loadIndex() {
+    QFile f(QDir(m_dir).filePath("index.json"));
+    if (!f.open(QIODevice::ReadOnly)) return;
+    const QJsonObject entries = QJsonDocument::fromJson(f.readAll()).object();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        // 旧版本写入的或被改动过的索引中可能有不能作为文件名的键
+        if (!isValidKey(it.key())) continue;
+        const QJsonObject o = it.value().toObject();
+        Entry e;
+        e.size = o.value("size").toInteger();
+        e.lastAccess = o.value("last_access").toInteger();
+        e.plays = o.value("plays").toInt();
+        e.oversize = o.value("oversize").toBool();
+        if (e.size > 0 && !QFile::exists(QDir(m_dir).filePath(it.key()))) e.size = 0;
+        m_totalBytes += e.size;
+        m_entries.insert(it.key(), e);
+    }
+}
+
+void MediaCache::download(const QString &key, const QUrl &url) {
+    if (m_downloading.contains(key)) return;
+
+    // 先打开临时文件再发请求：打开失败时没有需要清理的请求
+    const QString partPath = QDir(m_dir).filePath(key + ".part");
+    QFile *part = new QFile(partPath);
+    if (!part->open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open media cache file:" << part->errorString();
+        delete part;
+        return;
+    }
+    m_downloading.insert(key);
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QString::fromLatin1(kPlayerUserAgent));
+    request.setRawHeader("Referer", "https://music.163.com/");
+    QNetworkReply *reply = m_nam.get(request);
+    part->setParent(reply);
+    QElapsedTimer timer;
+    timer.start();
+
+    connect(reply, &QNetworkReply::readyRead, this, [reply, part, key, this]() {
+        part->write(reply->readAll());
+        // 单个文件不允许占用超过 1/4 的缓存空间；记录下来，之后播放时不再尝试
+        if (part->size() > m_maxBytes / 4) {
+            qInfo() << "Media file" << key << "exceeds a quarter of the cache size, not caching it";
+            m_entries[key].oversize = true;
+            reply->abort();
+        }
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, part, key, partPath, timer]() {
+        m_downloading.remove(key);
+        reply->deleteLater();
+        part->write(reply->readAll());
+        part->close();
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() != QNetworkReply::NoError || status != 200 || part->size() <= 0) {
+            QFile::remove(partPath);
+            return;
+        }
+        const QString path = QDir(m_dir).filePath(key);
+        QFile::remove(path);
+        if (!QFile::rename(partPath, path)) {
+            QFile::remove(partPath);
+            return;
+        }
+        Entry &e = m_entries[key];
+        e.size = QFileInfo(path).size();
+        e.lastAccess = QDateTime::currentSecsSinceEpoch();
+        m_totalBytes += e.size;
+        Metrics::instance().addSample("media_download", timer.elapsed());
+        Metrics::instance().increment("media_cache_bytes_downloaded", e.size);
+        emit downloadFinished(e.size, timer.elapsed());
+        evict();
+        saveIndex();
+    });
+}
+
+void MediaCache::evict() {
+    while (m_totalBytes > m_maxBytes) {
+        QString oldestKey;
+        qint64 oldest = std::numeric_limits<qint64>::max();
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            if (it->size > 0 && it->lastAccess < oldest) {
+                oldest = it->lastAccess;
+                oldestKey = it.key();
+            }
+        }
+        if (oldestKey.isEmpty()) break;
+        Entry &e = m_entries[oldestKey];
+        QFile::remove(QDir(m_dir).filePath(oldestKey));
+        m_totalBytes -= e.size;
+        e.size = 0;
+    }
+}
+
+void MediaCache::pruneUncached() {
+    int uncached = 0;
+    for (const Entry &e : std::as_const(m_entries)) {
+        if (e.size <= 0) uncached++;
+    }
+    while (uncached > kMaxUncachedEntries) {
+        auto oldestIt = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->size <= 0 && (oldestIt == m_entries.end() || it->lastAccess < oldestIt->lastAccess))
+                oldestIt = it;
+        }
+        if (oldestIt == m_entries.end()) break;
+        m_entries.erase(oldestIt);
+        uncached--;
+    }
+}
+
+void MediaCacheInterceptor::interceptRequest(QWebEngineUrlRequestInfo &info) {
+    if (info.resourceType() != QWebEngineUrlRequestInfo::ResourceTypeMedia) return;
+    const QUrl url = info.requestUrl();
+    if (!MediaCache::isMediaUrl(url)) return;
+    const QString key = MediaCache::keyForUrl(url);
+    if (!m_cache->lookup(key).isEmpty()) {
+        m_cache->recordHit(key);
+        info.redirect(QUrl(QString("%1:/%2").arg(QString::fromLatin1(kMediaCacheScheme), key)));
+        return;
+    }
+    m_cache->recordMiss();
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    m_cache->notePlay(url, info.httpHeaders().value("Range"));
+#else
+    m_cache->notePlay(url);
+#endif
+}
+
+void MediaSchemeHandler::requestStarted(QWebEngineUrlRequestJob *job) {
+    const QString key = job->requestUrl().path().mid(1);
+    const QString path = MediaCache::isValidKey(key) ? m_cache->filePath(key) : QString();
+    if (path.isEmpty()) {
+        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+    QFile *file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
+        job->fail(QWebEngineUrlRequestJob::RequestFailed);
+        return;
+    }
+    connect(job, &QObject::destroyed, file, &QObject::deleteLater);
+    job->reply(mimeTypeFor(key), file);
+}
+
+QByteArray MediaSchemeHandler::mimeTypeFor(const QString &key) {
+    const QString suffix = QFileInfo(key).suffix().toLower();
+    if (suffix == "flac") return "audio/flac";
+    if (suffix == "m4a" || suffix == "mp4") return "audio/mp4";
+    if (suffix == "ogg") return "audio/ogg";
+    return "audio/mpeg";
+}
+
+void registerMediaCacheScheme() {
+    QWebEngineUrlScheme scheme(kMediaCacheScheme);
+    scheme.setSyntax(QWebEngineUrlScheme::Syntax::Path);
+    scheme.setFlags(QWebEngineUrlScheme::SecureScheme | QWebEngineUrlScheme::CorsEnabled
+                    | QWebEngineUrlScheme::ContentSecurityPolicyIgnored);
+    QWebEngineUrlScheme::registerScheme(scheme);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+#include <QWebEngineUrlRequestInterceptor>
+#include <QWebEngineUrlSchemeHandler>
+
+// 播放页与后台下载共用的 User-Agent
+inline constexpr const char *kPlayerUserAgent =
+    "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120 Safari/537.36";
+
+// 本地缓存音频使用的自定义 scheme，需在 QApplication 构造前注册
+inline constexpr const char *kMediaCacheScheme = "cmw-media";
+
+// 独立于 HTTP 缓存的音频缓存：按 LRU 淘汰，总大小不超过 maxBytes。
+// 音频 URL 带有会过期的签名，但路径最后一段（文件名）对同一音频文件是稳定的，用它作为缓存键；
+// 缓存键直接用作缓存目录下的文件名，只接受 CDN 的命名形式（字母数字、'-'、'_' 加一个扩展名），其他 URL 不缓存。
+// 同一首歌被请求达到 minPlays 次后才在后台完整下载一份，之后的播放改由 cmw-media:// 从本地读取。
+// 索引保存在缓存目录下的 index.json。
+class MediaCache : public QObject {
+    Q_OBJECT
+
+public:
+    MediaCache(const QString &dir, qint64 maxBytes, QObject *parent = nullptr);
+
+    static bool isMediaUrl(const QUrl &url) {
+        return url.scheme() == "https" && url.host().endsWith(".music.126.net") && !keyForUrl(url).isEmpty();
+    }
+
+    // 文件名不符合 isValidKey 时返回空字符串
+    static QString keyForUrl(const QUrl &url);
+
+    static bool isValidKey(const QString &key);
+
+    void setMinPlays(int minPlays) { m_minPlays = qMax(1, minPlays); }
+
+    qint64 totalBytes() const { return m_totalBytes; }
+    qint64 hits() const { return m_hits; }
+    qint64 misses() const { return m_misses; }
+
+    // 命中时返回本地文件路径并更新访问时间，否则返回空字符串
+    QString lookup(const QString &key);
+
+    // 用于 scheme handler：只读取不更新访问时间
+    QString filePath(const QString &key) const;
+
+    // 拦截器看到一次音频请求。range 为请求的 Range 头：只有从头开始（bytes=0-）的请求才计为一次播放，
+    // 同一次播放中后续的 Range 请求不计；拿不到请求头时（Qt 6.5 之前）退回为与上一次请求的曲目相同则不计，
+    // 此时紧接着重播同一首歌不会计数
+    void notePlay(const QUrl &url, const QByteArray &range = QByteArray());
+
+    void recordHit(const QString &key);
+
+    void recordMiss();
+
+    void saveIndex() const;
+
+signals:
+    // 一次后台完整下载成功，用于估计网络吞吐
+    void downloadFinished(qint64 bytes, qint64 elapsedMs);
+    // 未命中缓存的音频开始一次新的播放（已按 notePlay 的规则合并同一次播放的请求）
+    void playStarted(const QUrl &url);
+
+private:
+    struct Entry {
+        qint64 size = 0;        // 0 表示尚未缓存，只记录播放次数
+        qint64 lastAccess = 0;  // 秒
+        int plays = 0;
+        bool oversize = false;  // 超过单文件上限（缓存的 1/4），不再下载
+    };
+
+    void loadIndex();
+    void download(const QString &key, const QUrl &url);
+    // 按最久未访问淘汰已缓存的文件，直到总大小不超过上限
+    void evict();
+    // 只记录播放次数的条目最多保留 kMaxUncachedEntries 个，丢弃最久未播放的
+    void pruneUncached();
+
+    static constexpr int kMaxUncachedEntries = 500;
+
+    QString m_dir;
+    qint64 m_maxBytes;
+    int m_minPlays = 2;
+    qint64 m_totalBytes = 0;
+    qint64 m_hits = 0;
+    qint64 m_misses = 0;
+    // 没有 Range 头时用于合并同一次播放的请求
+    QString m_lastKey;
+    QHash<QString, Entry> m_entries;
+    QSet<QString> m_downloading;
+    QNetworkAccessManager m_nam;
+};
+
+// 页面级拦截器：命中缓存的音频请求重定向到 cmw-media://，未命中的交给 MediaCache 统计播放次数
+class MediaCacheInterceptor : public QWebEngineUrlRequestInterceptor {
+    Q_OBJECT
+
+public:
+    MediaCacheInterceptor(MediaCache *cache, QObject *parent = nullptr)
+        : QWebEngineUrlRequestInterceptor(parent), m_cache(cache) {}
+
+    void interceptRequest(QWebEngineUrlRequestInfo &info) override;
+
+private:
+    MediaCache *m_cache;
+};
+
+// cmw-media:/<key> 的处理器：从缓存目录读取音频文件
+class MediaSchemeHandler : public QWebEngineUrlSchemeHandler {
+    Q_OBJECT
+
+public:
+    MediaSchemeHandler(MediaCache *cache, QObject *parent = nullptr)
+        : QWebEngineUrlSchemeHandler(parent), m_cache(cache) {}
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override;
+
+private:
+    static QByteArray mimeTypeFor(const QString &key);
+
+    MediaCache *m_cache;
+};
+
+// 注册 cmw-media scheme，必须在 QApplication 构造前调用
+void registerMediaCacheScheme();
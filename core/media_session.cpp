@@ -0,0 +1,72 @@
+#include "media_session.h"
+
+#include <QUrl>
+#include <QtMath>
+
+double MediaSession::position() const {
+    if (!m_playing || !m_positionClock.isValid()) return m_position;
+    const double pos = m_position + m_positionClock.elapsed() / 1000.0;
+    return m_duration > 0 ? qMin(pos, m_duration) : pos;
+}
+
+void MediaSession::updateFromState(const QJsonObject &state) {
+    const QString id = state.value("id").toString();
+    if (id.isEmpty()) return;
+
+    const bool trackChanged = id != m_trackId;
+    // 同一首歌已由元数据缓存补全的标题、歌手、专辑优先，页面的值只在缺失时使用
+    const auto pageValue = [&state, trackChanged](const char *key, const QString &current) {
+        const QString value = state.value(QLatin1String(key)).toString();
+        return trackChanged || current.isEmpty() ? value : current;
+    };
+    const QString title = pageValue("title", m_title);
+    const QString artist = pageValue("artist", m_artist);
+    const QString album = pageValue("album", m_album);
+    const bool metadataChanged = trackChanged || title != m_title || artist != m_artist
+                                 || state.value("artUrl").toString() != m_artUrl
+                                 || !qFuzzyCompare(state.value("duration").toDouble() + 1, m_duration + 1);
+    const double expected = position();
+    m_trackId = id;
+    m_title = title;
+    m_artist = artist;
+    m_album = album;
+    m_artUrl = state.value("artUrl").toString();
+    m_duration = state.value("duration").toDouble();
+    if (trackChanged) {
+        m_artFile.clear();
+        m_localArtUrl.clear();
+        m_lyrics.clear();
+    }
+
+    const bool playing = !state.value("paused").toBool(true);
+    const bool playbackChanged = playing != m_playing;
+    m_playing = playing;
+    m_position = state.value("time").toDouble();
+    m_positionClock.start();
+
+    if (metadataChanged) emit this->metadataChanged();
+    if (playbackChanged) emit this->playbackChanged();
+    // 与推算位置相差较大说明发生了跳转
+    if (!trackChanged && qAbs(m_position - expected) > 2.0) emit seeked(m_position);
+}
+
+void MediaSession::setTrackDetails(const QString &id, const QString &title, const QString &artist,
+                                   const QString &album, const QString &artFile, const QString &lyrics) {
+    if (id != m_trackId) return;
+    bool changed = false;
+    const auto assign = [&changed](QString &field, const QString &value) {
+        if (value.isEmpty() || field == value) return;
+        field = value;
+        changed = true;
+    };
+    assign(m_title, title);
+    assign(m_artist, artist);
+    assign(m_album, album);
+    assign(m_lyrics, lyrics);
+    if (!artFile.isEmpty() && artFile != m_artFile) {
+        m_artFile = artFile;
+        m_localArtUrl = QUrl::fromLocalFile(artFile).toString();
+        changed = true;
+    }
+    if (changed) emit metadataChanged();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "player_command.h"
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+
+// 平台无关的媒体会话：由页面推送的状态驱动（不轮询），并把命令交给 PlayerCommandDispatcher。
+// 各平台的系统媒体控制（MPRIS 等）都建立在它之上。
+class MediaSession : public QObject {
+    Q_OBJECT
+
+public:
+    explicit MediaSession(PlayerCommandDispatcher *dispatcher, QObject *parent = nullptr)
+        : QObject(parent), m_dispatcher(dispatcher) {}
+
+    QString trackId() const { return m_trackId; }
+    QString title() const { return m_title; }
+    QString artist() const { return m_artist; }
+    QString album() const { return m_album; }
+    // 元数据缓存已下载封面时返回本地 file:// 地址，否则为页面提供的远程地址
+    QString artUrl() const { return m_localArtUrl.isEmpty() ? m_artUrl : m_localArtUrl; }
+    QString artFile() const { return m_artFile; }
+    // LRC 格式歌词，来自元数据缓存
+    QString lyrics() const { return m_lyrics; }
+    double duration() const { return m_duration; }
+    bool isPlaying() const { return m_playing; }
+    bool hasTrack() const { return !m_trackId.isEmpty(); }
+
+    // 是否有可以显示的窗口（无界面模式下为 false，MPRIS 的 CanRaise 据此上报）
+    bool canRaise() const { return m_canRaise; }
+    void setCanRaise(bool canRaise) { m_canRaise = canRaise; }
+
+    // 当前位置（秒）：页面只在离散事件和每 5 秒推送一次，播放中按流逝时间推算
+    double position() const;
+
+    void updateFromState(const QJsonObject &state);
+
+    // 元数据缓存补充当前曲目的详情（id 不是当前曲目时忽略）；字段为空表示沿用页面提供的值
+    void setTrackDetails(const QString &id, const QString &title, const QString &artist, const QString &album,
+                         const QString &artFile, const QString &lyrics);
+
+    void play() { m_dispatcher->dispatch(PlayerCommand::Play); }
+    void pause() { m_dispatcher->dispatch(PlayerCommand::Pause); }
+    void playPause() { m_dispatcher->dispatch(PlayerCommand::PlayPause); }
+    void next() { m_dispatcher->dispatch(PlayerCommand::Next); }
+    void previous() { m_dispatcher->dispatch(PlayerCommand::Previous); }
+    void seek(double seconds) { m_dispatcher->dispatch(PlayerCommand::Seek, seconds); }
+    void seekBy(double seconds) { m_dispatcher->dispatch(PlayerCommand::SeekBy, seconds); }
+
+    void requestRaise() { emit raiseRequested(); }
+    void requestQuit() { emit quitRequested(); }
+
+signals:
+    void metadataChanged();
+    void playbackChanged();
+    void seeked(double position);
+    void raiseRequested();
+    void quitRequested();
+
+private:
+    PlayerCommandDispatcher *m_dispatcher;
+    QString m_trackId;
+    QString m_title;
+    QString m_artist;
+    QString m_album;
+    QString m_artUrl;
+    QString m_artFile;
+    QString m_localArtUrl;
+    QString m_lyrics;
+    double m_duration = 0.0;
+    double m_position = 0.0;
+    bool m_playing = false;
+    bool m_canRaise = true;
+    QElapsedTimer m_positionClock;
+};
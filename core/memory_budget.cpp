@@ -0,0 +1,36 @@
+#include "memory_budget.h"
+
+#include "metrics.h"
+#include "process_stats.h"
+#include "state_store.h"
+
+#include <QDebug>
+#include <QWebEnginePage>
+
+MemoryBudget::MemoryBudget(QWebEnginePage *page, StateStore *stateStore, qint64 budgetBytes, QObject *parent)
+    : QObject(parent), m_page(page), m_stateStore(stateStore), m_budgetBytes(budgetBytes),
+      m_timer("memory.sample", ScheduledJob::Deferrable) {
+    connect(&m_timer, &ScheduledJob::timeout, this, &MemoryBudget::sample);
+    m_timer.setInterval(60000);
+    m_timer.start();
+}
+
+void MemoryBudget::sample() {
+    m_lastResident = processResidentBytes(m_page->renderProcessPid());
+    if (m_lastResident < 0) return;
+    Metrics::instance().addSample("renderer_rss_mb", m_lastResident / (1024 * 1024));
+    if (m_budgetBytes <= 0 || m_lastResident <= m_budgetBytes) return;
+
+    const bool paused = m_stateStore->current().value("paused").toBool(true);
+    if (!paused) return;
+    if (m_lastReload.isValid() && m_lastReload.elapsed() < kReloadCooldownMs) return;
+
+    qInfo().nospace() << "Renderer memory " << m_lastResident / (1024 * 1024) << " MB exceeds budget "
+                      << m_budgetBytes / (1024 * 1024) << " MB, reloading page";
+    Metrics::instance().increment("memory_budget_reloads");
+    m_stateStore->flush();
+    m_lastReload.start();
+    if (m_page->lifecycleState() != QWebEnginePage::LifecycleState::Active)
+        m_page->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+    m_page->triggerAction(QWebEnginePage::Reload);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "power_scheduler.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+
+class QWebEnginePage;
+class StateStore;
+
+// 长时间运行时的渲染进程内存预算：定期采样渲染进程常驻内存，
+// 超出预算且当前处于暂停状态时，先把状态落盘再重新加载页面，由 loadFinished 的恢复逻辑回到原来的位置。
+// 两次重新加载之间至少间隔 kReloadCooldownMs，避免页面本身就超出预算时反复重载。
+class MemoryBudget : public QObject {
+    Q_OBJECT
+
+public:
+    MemoryBudget(QWebEnginePage *page, StateStore *stateStore, qint64 budgetBytes, QObject *parent = nullptr);
+
+    void setSampleInterval(int intervalMs) { m_timer.setInterval(intervalMs); }
+
+    qint64 lastResidentBytes() const { return m_lastResident; }
+
+private:
+    void sample();
+
+    static constexpr qint64 kReloadCooldownMs = 10 * 60 * 1000;
+
+    QWebEnginePage *m_page;
+    StateStore *m_stateStore;
+    qint64 m_budgetBytes;
+    qint64 m_lastResident = -1;
+    ScheduledJob m_timer;
+    QElapsedTimer m_lastReload;
+};
@@ -0,0 +1,296 @@
+#include "metadata_cache.h"
+
+#include "media_cache.h"
+#include "metrics.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QStringList>
+#include <QUrl>
+#include <QUrlQuery>
+
+#include <limits>
+
+MetadataCache::MetadataCache(const QString &dir, QObject *parent) : QObject(parent), m_dir(dir), m_saveTimer("metadata.save", ScheduledJob::Deferrable) {
+    QDir().mkpath(QDir(m_dir).filePath("lyrics"));
+    QDir().mkpath(QDir(m_dir).filePath("art"));
+    loadIndex();
+
+    // 索引变化后 5 秒内合并写入
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(5000);
+    connect(&m_saveTimer, &ScheduledJob::timeout, this, &MetadataCache::saveIndex);
+}
+
+bool MetadataCache::isSongId(const QString &id) {
+    if (id.isEmpty()) return false;
+    for (const QChar c : id) {
+        if (!c.isDigit()) return false;
+    }
+    return true;
+}
+
+QString MetadataCache::fileStem(const QString &id) {
+    if (isSongId(id)) return id;
+    return QString::fromLatin1(QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+QString MetadataCache::artPath(const QString &id) const {
+    return QDir(m_dir).filePath("art/" + fileStem(id) + ".jpg");
+}
+
+QString MetadataCache::lyricsPath(const QString &id) const {
+    return QDir(m_dir).filePath("lyrics/" + fileStem(id) + ".lrc");
+}
+
+void MetadataCache::observe(const QJsonObject &state) {
+    const QString id = state.value("id").toString();
+    if (id.isEmpty()) return;
+
+    Track &t = m_tracks[id];
+    bool changed = false;
+    // 接口详情更完整，只用页面的值填补空缺
+    const auto fill = [&state, &changed](QString &field, const char *key) {
+        const QString value = state.value(QLatin1String(key)).toString();
+        if (field.isEmpty() && !value.isEmpty()) {
+            field = value;
+            changed = true;
+        }
+    };
+    fill(t.title, "title");
+    fill(t.artist, "artist");
+    fill(t.album, "album");
+    fill(t.artUrl, "artUrl");
+    if (t.duration <= 0 && state.value("duration").toDouble() > 0) {
+        t.duration = state.value("duration").toDouble();
+        changed = true;
+    }
+    if (id != m_currentId) {
+        m_currentId = id;
+        t.lastUsed = QDateTime::currentSecsSinceEpoch();
+        changed = true;
+        Metrics::instance().increment(t.detailFetched ? "metadata_hits" : "metadata_misses");
+        evict();
+    }
+    if (changed) scheduleSave();
+
+    prefetch(id);
+    const QString next = state.value("next").toString();
+    if (!next.isEmpty() && next != id) prefetch(next);
+}
+
+void MetadataCache::prefetch(const QString &id) {
+    Track &t = m_tracks[id];
+    // 预取的下一首还没有播放过，按现在记为使用时间，避免抓取后立即被淘汰
+    if (t.lastUsed == 0) t.lastUsed = QDateTime::currentSecsSinceEpoch();
+    if (isSongId(id)) {
+        if (!t.detailFetched) fetchDetail(id);
+        if (t.lyrics == 0) fetchLyrics(id);
+    }
+    if (!t.hasArt && !t.artUrl.isEmpty()) fetchArt(id);
+}
+
+QString MetadataCache::artFile(const QString &id) const {
+    auto it = m_tracks.constFind(id);
+    if (it == m_tracks.constEnd() || !it->hasArt) return QString();
+    return artPath(id);
+}
+
+QString MetadataCache::lyrics(const QString &id) {
+    auto cached = m_lyrics.constFind(id);
+    if (cached != m_lyrics.constEnd()) return *cached;
+    if (m_tracks.value(id).lyrics <= 0) return QString();
+    QFile f(lyricsPath(id));
+    if (!f.open(QIODevice::ReadOnly)) return QString();
+    const QString text = QString::fromUtf8(f.readAll());
+    rememberLyrics(id, text);
+    return text;
+}
+
+void MetadataCache::rememberLyrics(const QString &id, const QString &lyrics) {
+    if (!m_lyrics.contains(id)) m_lyricsOrder.append(id);
+    m_lyrics.insert(id, lyrics);
+    while (m_lyricsOrder.size() > kMaxLyricsInMemory) m_lyrics.remove(m_lyricsOrder.takeFirst());
+}
+
+void MetadataCache::saveIndex() const {
+    QJsonObject tracks;
+    for (auto it = m_tracks.cbegin(); it != m_tracks.cend(); ++it) {
+        QJsonObject o;
+        if (!it->title.isEmpty()) o["title"] = it->title;
+        if (!it->artist.isEmpty()) o["artist"] = it->artist;
+        if (!it->album.isEmpty()) o["album"] = it->album;
+        if (!it->artUrl.isEmpty()) o["art_url"] = it->artUrl;
+        if (it->duration > 0) o["duration"] = it->duration;
+        o["last_used"] = it->lastUsed;
+        if (it->detailFetched) o["detail"] = true;
+        if (it->hasArt) o["art"] = true;
+        if (it->lyrics != 0) o["lyrics"] = it->lyrics;
+        tracks.insert(it.key(), o);
+    }
+    QSaveFile f(QDir(m_dir).filePath("index.json"));
+    if (!f.open(QIODevice::WriteOnly)) return;
+    f.write(QJsonDocument(tracks).toJson(QJsonDocument::Compact));
+    f.commit();
+}
+
+void MetadataCache::loadIndex() {
+    QFile f(QDir(m_dir).filePath("index.json"));
+    if (!f.open(QIODevice::ReadOnly)) return;
+    const QJsonObject tracks = QJsonDocument::fromJson(f.readAll()).object();
+    for (auto it = tracks.constBegin(); it != tracks.constEnd(); ++it) {
+        const QJsonObject o = it.value().toObject();
+        Track t;
+        t.title = o.value("title").toString();
+        t.artist = o.value("artist").toString();
+        t.album = o.value("album").toString();
+        t.artUrl = o.value("art_url").toString();
+        t.duration = o.value("duration").toDouble();
+        t.lastUsed = o.value("last_used").toInteger();
+        t.detailFetched = o.value("detail").toBool();
+        t.hasArt = o.value("art").toBool() && QFile::exists(artPath(it.key()));
+        t.lyrics = o.value("lyrics").toInt();
+        if (t.lyrics > 0 && !QFile::exists(lyricsPath(it.key()))) t.lyrics = 0;
+        m_tracks.insert(it.key(), t);
+    }
+}
+
+void MetadataCache::scheduleSave() {
+    if (!m_saveTimer.isActive()) m_saveTimer.start();
+}
+
+QNetworkReply *MetadataCache::get(const QUrl &url) {
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QString::fromLatin1(kPlayerUserAgent));
+    request.setRawHeader("Referer", "https://music.163.com/");
+    request.setTransferTimeout(15000);
+    return m_nam.get(request);
+}
+
+void MetadataCache::fetchDetail(const QString &id) {
+    const QString key = "detail:" + id;
+    if (m_requested.contains(key)) return;
+    m_requested.insert(key);
+
+    QUrl url("https://music.163.com/api/song/detail/");
+    QUrlQuery query;
+    query.addQueryItem("id", id);
+    query.addQueryItem("ids", "[" + id + "]");
+    url.setQuery(query);
+    QElapsedTimer timer;
+    timer.start();
+    QNetworkReply *reply = get(url);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, id, timer]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) {
+            qWarning() << "Song detail request failed for" << id << reply->errorString();
+            return;
+        }
+        const QJsonArray songs = QJsonDocument::fromJson(reply->readAll()).object().value("songs").toArray();
+        if (songs.isEmpty()) return;
+        Metrics::instance().addSample("metadata_detail", timer.elapsed());
+
+        const QJsonObject song = songs.first().toObject();
+        Track &t = m_tracks[id];
+        t.title = song.value("name").toString(t.title);
+        QStringList artists;
+        for (const QJsonValue &artist : song.value("artists").toArray()) artists << artist.toObject().value("name").toString();
+        if (!artists.isEmpty()) t.artist = artists.join(" / ");
+        const QJsonObject album = song.value("album").toObject();
+        t.album = album.value("name").toString(t.album);
+        const QString picUrl = album.value("picUrl").toString();
+        // 托盘图标与 MPRIS 只需要小图
+        if (!picUrl.isEmpty()) t.artUrl = picUrl + "?param=300y300";
+        if (song.value("duration").toDouble() > 0) t.duration = song.value("duration").toDouble() / 1000.0;
+        t.detailFetched = true;
+        scheduleSave();
+        emit trackUpdated(id);
+        if (!t.hasArt && !t.artUrl.isEmpty()) fetchArt(id);
+    });
+}
+
+void MetadataCache::fetchLyrics(const QString &id) {
+    const QString key = "lyrics:" + id;
+    if (m_requested.contains(key)) return;
+    m_requested.insert(key);
+
+    QUrl url("https://music.163.com/api/song/lyric");
+    QUrlQuery query;
+    query.addQueryItem("id", id);
+    query.addQueryItem("lv", "-1");
+    url.setQuery(query);
+    QNetworkReply *reply = get(url);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, id]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) {
+            qWarning() << "Lyrics request failed for" << id << reply->errorString();
+            return;
+        }
+        const QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+        if (obj.value("code").toInt() != 200) return;
+        const QString text = obj.value("lrc").toObject().value("lyric").toString();
+        Track &t = m_tracks[id];
+        if (text.isEmpty()) {
+            t.lyrics = -1;
+        } else {
+            QSaveFile f(lyricsPath(id));
+            if (!f.open(QIODevice::WriteOnly)) return;
+            f.write(text.toUtf8());
+            if (!f.commit()) return;
+            t.lyrics = 1;
+            rememberLyrics(id, text);
+        }
+        scheduleSave();
+        emit trackUpdated(id);
+    });
+}
+
+void MetadataCache::fetchArt(const QString &id) {
+    const QString key = "art:" + id;
+    if (m_requested.contains(key)) return;
+    m_requested.insert(key);
+
+    QNetworkReply *reply = get(QUrl(m_tracks.value(id).artUrl));
+    connect(reply, &QNetworkReply::finished, this, [this, reply, id]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) {
+            qWarning() << "Artwork request failed for" << id << reply->errorString();
+            return;
+        }
+        QSaveFile f(artPath(id));
+        if (!f.open(QIODevice::WriteOnly)) return;
+        f.write(reply->readAll());
+        if (!f.commit()) return;
+        m_tracks[id].hasArt = true;
+        scheduleSave();
+        emit trackUpdated(id);
+    });
+}
+
+void MetadataCache::evict() {
+    while (m_tracks.size() > kMaxTracks) {
+        QString oldestId;
+        qint64 oldest = std::numeric_limits<qint64>::max();
+        for (auto it = m_tracks.cbegin(); it != m_tracks.cend(); ++it) {
+            if (it.key() != m_currentId && it->lastUsed < oldest) {
+                oldest = it->lastUsed;
+                oldestId = it.key();
+            }
+        }
+        if (oldestId.isEmpty()) break;
+        QFile::remove(lyricsPath(oldestId));
+        QFile::remove(artPath(oldestId));
+        m_tracks.remove(oldestId);
+        m_lyrics.remove(oldestId);
+        m_lyricsOrder.removeAll(oldestId);
+    }
+}
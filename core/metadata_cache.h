@@ -0,0 +1,89 @@
+#pragma once
+
+#include "power_scheduler.h"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class QNetworkReply;
+
+// 曲目元数据缓存：标题、歌手、专辑、时长、封面与歌词。
+// 页面推送的播放状态（id、标题等）先填入已知字段，真实歌曲 id 再通过 music.163.com 的歌曲详情与歌词接口补全，
+// 封面下载到本地，状态中的 next（播放列表中的下一首）提前抓取。托盘、通知和 MPRIS 由此从内存读取，不需要访问页面。
+// 目录结构：index.json（紧凑索引，不含歌词）、lyrics/<id>.lrc、art/<id>.jpg
+class MetadataCache : public QObject {
+    Q_OBJECT
+
+public:
+    struct Track {
+        QString title;
+        QString artist;
+        QString album;
+        QString artUrl;         // 远程封面地址
+        double duration = 0.0;  // 秒
+        qint64 lastUsed = 0;    // 秒
+        bool detailFetched = false;
+        bool hasArt = false;
+        int lyrics = 0;         // 0 未知，1 有歌词，-1 无歌词（纯音乐等）
+    };
+
+    explicit MetadataCache(const QString &dir, QObject *parent = nullptr);
+
+    // 页面推送的播放状态：补全已知字段，按需抓取当前曲目并预取下一首
+    void observe(const QJsonObject &state);
+
+    // 后台抓取详情、歌词与封面，已缓存的部分跳过
+    void prefetch(const QString &id);
+
+    bool contains(const QString &id) const { return m_tracks.contains(id); }
+    Track track(const QString &id) const { return m_tracks.value(id); }
+
+    // 本地封面文件路径，尚未下载时返回空字符串
+    QString artFile(const QString &id) const;
+
+    // LRC 格式歌词，最近用到的几首保存在内存中，其余从磁盘读取；没有歌词时返回空字符串
+    QString lyrics(const QString &id);
+
+    void saveIndex() const;
+
+signals:
+    // 某首歌的元数据有了新内容（详情、歌词或封面）
+    void trackUpdated(const QString &id);
+
+private:
+    // 只有数字 id 是真实歌曲 id，"t:" 开头的替代 id 无法查询接口
+    static bool isSongId(const QString &id);
+
+    // 歌词与封面的缓存文件路径。替代 id 包含标题等任意字符（'/'、':'、".." 等），
+    // 不能直接作为文件名，改用 id 的 SHA-1；数字 id 保持原样
+    static QString fileStem(const QString &id);
+    QString artPath(const QString &id) const;
+    QString lyricsPath(const QString &id) const;
+
+    void loadIndex();
+    void scheduleSave();
+    QNetworkReply *get(const QUrl &url);
+    void fetchDetail(const QString &id);
+    void fetchLyrics(const QString &id);
+    void fetchArt(const QString &id);
+    void rememberLyrics(const QString &id, const QString &lyrics);
+    // 条目超过 kMaxTracks 时按最久未使用淘汰，连同歌词和封面文件
+    void evict();
+
+    static constexpr int kMaxTracks = 2000;
+    static constexpr int kMaxLyricsInMemory = 8;
+
+    QString m_dir;
+    QString m_currentId;
+    QHash<QString, Track> m_tracks;
+    QHash<QString, QString> m_lyrics;
+    QStringList m_lyricsOrder;
+    // 正在进行的请求，键为 "<kind>:<id>"；请求失败的同样记录，本次运行内不再重试
+    QSet<QString> m_requested;
+    QNetworkAccessManager m_nam;
+    ScheduledJob m_saveTimer;
+};
@@ -0,0 +1,80 @@
+#include "metrics.h"
+
+#include "trace_recorder.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QWebEnginePage>
+
+Metrics &Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::mark(const QString &name) {
+    // 跟踪中记录每一次（如每次 load_started），指标只保留第一次
+    TraceRecorder::instance().instant("phase", name);
+    if (m_marks.contains(name)) return;
+    const qint64 at = elapsed();
+    m_marks.insert(name, at);
+    qDebug().nospace() << "Startup: " << name << " at " << at << " ms";
+}
+
+void Metrics::addSample(const QString &name, qint64 ms) {
+    Stats &s = m_samples[name];
+    s.count++;
+    s.total += ms;
+    s.last = ms;
+    if (s.count == 1 || ms < s.min) s.min = ms;
+    if (ms > s.max) s.max = ms;
+}
+
+QJsonObject Metrics::toJson() const {
+    QJsonObject counters;
+    for (auto it = m_counters.cbegin(); it != m_counters.cend(); ++it) counters.insert(it.key(), it.value());
+    QJsonObject marks;
+    for (auto it = m_marks.cbegin(); it != m_marks.cend(); ++it) marks.insert(it.key(), it.value());
+    QJsonObject samples;
+    for (auto it = m_samples.cbegin(); it != m_samples.cend(); ++it) {
+        const Stats &s = it.value();
+        QJsonObject o;
+        o["count"] = s.count;
+        o["avg_ms"] = s.count ? double(s.total) / s.count : 0.0;
+        o["min_ms"] = s.min;
+        o["max_ms"] = s.max;
+        o["last_ms"] = s.last;
+        samples.insert(it.key(), o);
+    }
+    QJsonObject root;
+    root["generated_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["uptime_ms"] = elapsed();
+    root["qt_version"] = QString::fromLatin1(qVersion());
+    root["marks"] = marks;
+    root["samples"] = samples;
+    root["counters"] = counters;
+    return root;
+}
+
+bool Metrics::writeJson(const QString &filePath) const {
+    QSaveFile f(filePath);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    f.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    return f.commit();
+}
+
+void runJavaScriptTimed(QWebEnginePage *page, const QString &name, const QString &js, quint32 worldId,
+                        const std::function<void(const QVariant &)> &callback) {
+    QElapsedTimer timer;
+    timer.start();
+    TraceRecorder &trace = TraceRecorder::instance();
+    const quint64 traceId = trace.isEnabled() ? trace.nextId() : 0;
+    if (traceId) trace.asyncBegin("js", "js." + name, traceId);
+    page->runJavaScript(js, worldId, [name, timer, callback, traceId](const QVariant &v) {
+        const qint64 elapsed = timer.elapsed();
+        Metrics::instance().addSample("js." + name, elapsed);
+        if (traceId) TraceRecorder::instance().asyncEnd("js", "js." + name, traceId, elapsed);
+        if (callback) callback(v);
+    });
+}
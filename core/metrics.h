@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QVariant>
+
+#include <functional>
+
+class QWebEnginePage;
+
+// 内置的性能指标记录：启动各阶段的时间点（相对进程启动）、各类耗时样本（如每次 runJavaScript 的往返时间）。
+// 记录本身开销很小，始终开启；使用 --metrics 启动时，退出前把结果写入数据目录下的 metrics.json 并输出到日志。
+class Metrics {
+public:
+    static Metrics &instance();
+
+    // 进程启动后尽早调用，之后所有时间点都相对于这一刻
+    void start() { m_clock.start(); }
+
+    qint64 elapsed() const { return m_clock.isValid() ? m_clock.elapsed() : 0; }
+
+    // 记录一个阶段时间点，同名阶段只记录第一次（例如只关心首次 loadFinished）
+    void mark(const QString &name);
+
+    void addSample(const QString &name, qint64 ms);
+
+    void increment(const QString &counter, qint64 by = 1) { m_counters[counter] += by; }
+
+    // 直接设置计数，用于“最近一次测量值”一类的指标
+    void setCounter(const QString &counter, qint64 value) { m_counters[counter] = value; }
+
+    qint64 counter(const QString &counter) const { return m_counters.value(counter); }
+
+    QJsonObject toJson() const;
+
+    bool writeJson(const QString &filePath) const;
+
+private:
+    struct Stats {
+        qint64 count = 0;
+        qint64 total = 0;
+        qint64 min = 0;
+        qint64 max = 0;
+        qint64 last = 0;
+    };
+
+    Metrics() = default;
+
+    QElapsedTimer m_clock;
+    QMap<QString, qint64> m_marks;
+    QMap<QString, Stats> m_samples;
+    QMap<QString, qint64> m_counters;
+};
+
+// 带计时的 runJavaScript：往返时间记录为 js.<name> 样本
+void runJavaScriptTimed(QWebEnginePage *page, const QString &name, const QString &js, quint32 worldId,
+                        const std::function<void(const QVariant &)> &callback = {});
@@ -0,0 +1,168 @@
+#include "mpris.h"
+
+#include "media_session.h"
+
+#include <QDBusAbstractAdaptor>
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDebug>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVariantMap>
+
+static const char *kMprisObjectPath = "/org/mpris/MediaPlayer2";
+
+// org.mpris.MediaPlayer2
+class MprisRootAdaptor : public QDBusAbstractAdaptor {
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.mpris.MediaPlayer2")
+    Q_PROPERTY(bool CanQuit READ canQuit)
+    Q_PROPERTY(bool CanRaise READ canRaise)
+    Q_PROPERTY(bool HasTrackList READ hasTrackList)
+    Q_PROPERTY(QString Identity READ identity)
+    Q_PROPERTY(QStringList SupportedUriSchemes READ supportedUriSchemes)
+    Q_PROPERTY(QStringList SupportedMimeTypes READ supportedMimeTypes)
+
+public:
+    MprisRootAdaptor(MediaSession *session, QObject *parent)
+        : QDBusAbstractAdaptor(parent), m_session(session) {}
+
+    bool canQuit() const { return true; }
+    bool canRaise() const { return m_session->canRaise(); }
+    bool hasTrackList() const { return false; }
+    QString identity() const { return "网易云音乐 Web 播放器"; }
+    QStringList supportedUriSchemes() const { return {}; }
+    QStringList supportedMimeTypes() const { return {}; }
+
+public slots:
+    void Raise() { m_session->requestRaise(); }
+    void Quit() { m_session->requestQuit(); }
+
+private:
+    MediaSession *m_session;
+};
+
+// org.mpris.MediaPlayer2.Player
+class MprisPlayerAdaptor : public QDBusAbstractAdaptor {
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.mpris.MediaPlayer2.Player")
+    Q_PROPERTY(QString PlaybackStatus READ playbackStatus)
+    Q_PROPERTY(double Rate READ rate)
+    Q_PROPERTY(double MinimumRate READ rate)
+    Q_PROPERTY(double MaximumRate READ rate)
+    Q_PROPERTY(QVariantMap Metadata READ metadata)
+    Q_PROPERTY(double Volume READ volume)
+    Q_PROPERTY(qlonglong Position READ position)
+    Q_PROPERTY(bool CanGoNext READ canControl)
+    Q_PROPERTY(bool CanGoPrevious READ canControl)
+    Q_PROPERTY(bool CanPlay READ canControl)
+    Q_PROPERTY(bool CanPause READ canControl)
+    Q_PROPERTY(bool CanSeek READ canSeek)
+    Q_PROPERTY(bool CanControl READ canControl)
+
+public:
+    MprisPlayerAdaptor(MediaSession *session, QObject *parent)
+        : QDBusAbstractAdaptor(parent), m_session(session) {
+        connect(session, &MediaSession::metadataChanged, this, [this]() {
+            notifyPropertiesChanged({{"Metadata", metadata()}, {"CanSeek", canSeek()}});
+        });
+        connect(session, &MediaSession::playbackChanged, this, [this]() {
+            notifyPropertiesChanged({{"PlaybackStatus", playbackStatus()}});
+        });
+        connect(session, &MediaSession::seeked, this, [this](double position) {
+            emit Seeked(static_cast<qlonglong>(position * 1000000));
+        });
+    }
+
+    QString playbackStatus() const {
+        if (!m_session->hasTrack()) return "Stopped";
+        return m_session->isPlaying() ? "Playing" : "Paused";
+    }
+    double rate() const { return 1.0; }
+    double volume() const { return 1.0; }
+    qlonglong position() const { return static_cast<qlonglong>(m_session->position() * 1000000); }
+    bool canControl() const { return true; }
+    bool canSeek() const { return m_session->duration() > 0; }
+
+    QVariantMap metadata() const {
+        QVariantMap map;
+        if (!m_session->hasTrack()) return map;
+        map["mpris:trackid"] = QVariant::fromValue(QDBusObjectPath(trackObjectPath()));
+        if (m_session->duration() > 0)
+            map["mpris:length"] = static_cast<qlonglong>(m_session->duration() * 1000000);
+        if (!m_session->artUrl().isEmpty()) map["mpris:artUrl"] = m_session->artUrl();
+        map["xesam:title"] = m_session->title();
+        if (!m_session->artist().isEmpty()) map["xesam:artist"] = QStringList{m_session->artist()};
+        if (!m_session->album().isEmpty()) map["xesam:album"] = m_session->album();
+        if (!m_session->lyrics().isEmpty()) map["xesam:asText"] = plainLyrics(m_session->lyrics());
+        return map;
+    }
+
+private:
+    // xesam:asText 是纯文本歌词：去掉 LRC 的时间标签和 [ar:] 等信息行
+    static QString plainLyrics(const QString &lrc) {
+        static const QRegularExpression tag(QStringLiteral("^(\\[[^\\]]*\\])+"));
+        QStringList lines;
+        for (const QString &line : lrc.split('\n')) {
+            const QString text = QString(line).remove(tag).trimmed();
+            if (!text.isEmpty()) lines << text;
+        }
+        return lines.join('\n');
+    }
+
+public slots:
+    void Next() { m_session->next(); }
+    void Previous() { m_session->previous(); }
+    void Pause() { m_session->pause(); }
+    void PlayPause() { m_session->playPause(); }
+    void Stop() { m_session->pause(); }
+    void Play() { m_session->play(); }
+    void Seek(qlonglong offsetUs) { m_session->seekBy(offsetUs / 1000000.0); }
+    void SetPosition(const QDBusObjectPath &trackId, qlonglong positionUs) {
+        // 规范要求 trackId 与当前曲目不一致时忽略
+        if (trackId.path() != trackObjectPath()) return;
+        m_session->seek(positionUs / 1000000.0);
+    }
+    void OpenUri(const QString &) {}
+
+signals:
+    void Seeked(qlonglong positionUs);
+
+private:
+    // D-Bus object path 只允许 [A-Za-z0-9_]，其余字符替换为 '_'
+    QString trackObjectPath() const {
+        QString id = m_session->trackId();
+        for (QChar &c : id) {
+            if (!(c.isLetterOrNumber() && c.unicode() < 128) && c != '_') c = '_';
+        }
+        return "/org/cloudmusic/track/" + (id.isEmpty() ? QString("none") : id);
+    }
+
+    void notifyPropertiesChanged(const QVariantMap &changed) {
+        QDBusMessage signal = QDBusMessage::createSignal(kMprisObjectPath, "org.freedesktop.DBus.Properties",
+                                                         "PropertiesChanged");
+        signal << QString("org.mpris.MediaPlayer2.Player") << changed << QStringList();
+        QDBusConnection::sessionBus().send(signal);
+    }
+
+    MediaSession *m_session;
+};
+
+void registerMprisService(MediaSession *session) {
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        qWarning() << "D-Bus session bus not available, MPRIS disabled";
+        return;
+    }
+    QObject *root = new QObject(session);
+    new MprisRootAdaptor(session, root);
+    new MprisPlayerAdaptor(session, root);
+    if (!bus.registerObject(kMprisObjectPath, root, QDBusConnection::ExportAdaptors)
+        || !bus.registerService("org.mpris.MediaPlayer2.CloudMusicWebPlayerQt")) {
+        qWarning() << "Failed to register MPRIS service:" << bus.lastError().message();
+    }
+}
+
+#include "mpris.moc"
@@ -0,0 +1,11 @@
+#pragma once
+
+// MPRIS（Linux 系统媒体控制）：仅在构建时找到 Qt6 DBus 时编译（CMW_HAVE_DBUS）
+#if defined(CMW_HAVE_DBUS)
+
+class MediaSession;
+
+// 在会话总线上注册 MPRIS 服务，失败时（例如没有会话总线）只输出警告
+void registerMprisService(MediaSession *session);
+
+#endif
@@ -0,0 +1,128 @@
+#include "navigation_policy.h"
+
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QNetworkInformation>
+#include <QSettings>
+#include <QStringList>
+#include <QWebEnginePage>
+
+// 网易云音乐登录会经过的第三方域名（网易通行证、微信、QQ、微博）
+static const char *const kAuthHosts[] = {
+    "reg.163.com",
+    "passport.163.com",
+    "id.163.com",
+    "open.weixin.qq.com",
+    "graph.qq.com",
+    "ptlogin2.qq.com",
+    "api.weibo.com",
+};
+
+NavigationPolicy::NavigationPolicy(QWebEnginePage *page, const QUrl &homeUrl, QObject *parent)
+    : QObject(parent), m_page(page), m_homeUrl(homeUrl) {
+    addAllowedHost(homeUrl.host());
+    for (const char *host : kAuthHosts) addAllowedHost(QString::fromLatin1(host));
+    {
+        QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+        for (const QString &host : settings.value("navigation/allowedHosts").toStringList()) {
+            if (!host.trimmed().isEmpty()) addAllowedHost(host.trimmed());
+        }
+    }
+
+    m_retryTimer.setSingleShot(true);
+    connect(&m_retryTimer, &QTimer::timeout, this, &NavigationPolicy::returnHome);
+    connect(page, &QWebEnginePage::urlChanged, this, &NavigationPolicy::onUrlChanged);
+    connect(page, &QWebEnginePage::loadFinished, this, &NavigationPolicy::onLoadFinished);
+
+    if (!QNetworkInformation::instance()) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+        QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Reachability);
+#else
+        QNetworkInformation::load(QNetworkInformation::Feature::Reachability);
+#endif
+    }
+    if (QNetworkInformation *info = QNetworkInformation::instance()) {
+        connect(info, &QNetworkInformation::reachabilityChanged, this, &NavigationPolicy::onNetworkChanged);
+        connect(info, &QNetworkInformation::isBehindCaptivePortalChanged, this, &NavigationPolicy::onNetworkChanged);
+    } else {
+        qDebug() << "No network information backend, offline detection disabled";
+    }
+}
+
+bool NavigationPolicy::isAllowed(const QUrl &url) const {
+    if (!url.isValid()) return false;
+    // 与请求屏蔽相同，按 host 逐级后缀查表
+    QString host = url.host().toLower();
+    while (!host.isEmpty()) {
+        if (m_allowedHosts.contains(host)) return true;
+        const int dot = host.indexOf('.');
+        if (dot < 0) break;
+        host = host.mid(dot + 1);
+    }
+    return false;
+}
+
+bool NavigationPolicy::isOnline() {
+    const QNetworkInformation *info = QNetworkInformation::instance();
+    if (!info) return true;
+    if (info->supports(QNetworkInformation::Feature::CaptivePortal) && info->isBehindCaptivePortal()) return false;
+    const QNetworkInformation::Reachability reachability = info->reachability();
+    return reachability == QNetworkInformation::Reachability::Online
+           || reachability == QNetworkInformation::Reachability::Unknown;
+}
+
+void NavigationPolicy::onUrlChanged(const QUrl &url) {
+    if (isAllowed(url)) return;
+    qDebug() << "Navigation left allowed hosts:" << url.host();
+    scheduleReturn("redirect");
+}
+
+void NavigationPolicy::onLoadFinished(bool ok) {
+    // 只处理播放页本身的加载失败；登录页加载失败交给用户处理
+    if (ok || m_page->url().host() != m_homeUrl.host()) return;
+    Metrics::instance().increment("navigation_load_failures");
+    scheduleReturn("load failed");
+}
+
+void NavigationPolicy::onNetworkChanged() {
+    if (!m_pending || !isOnline()) return;
+    qInfo() << "Network is back, returning to player page";
+    Metrics::instance().increment("navigation_resumes");
+    m_pending = false;
+    m_attempts = 0;
+    m_retryTimer.stop();
+    returnHome();
+}
+
+void NavigationPolicy::scheduleReturn(const char *reason) {
+    if (m_retryTimer.isActive() || m_pending) return;
+    Metrics &metrics = Metrics::instance();
+    if (!isOnline()) {
+        qInfo() << "Offline or behind a captive portal, pausing reload (" << reason << ")";
+        metrics.increment("navigation_offline_pauses");
+        m_pending = true;
+        return;
+    }
+
+    if (m_lastAttempt.isValid() && m_lastAttempt.elapsed() > kStableAfterMs) m_attempts = 0;
+    const int delay = m_attempts == 0 ? 0 : qMin(kMaxRetryDelayMs, kInitialRetryDelayMs << qMin(m_attempts - 1, 20));
+    ++m_attempts;
+    metrics.increment("navigation_redirects");
+    if (delay > 0) {
+        metrics.increment("navigation_backoffs");
+        qDebug() << "Returning to player page in" << delay << "ms (" << reason << ", attempt" << m_attempts << ")";
+    }
+    m_retryTimer.start(delay);
+}
+
+void NavigationPolicy::returnHome() {
+    if (!isOnline()) {
+        m_pending = true;
+        return;
+    }
+    qDebug() << "Redirecting to player page...";
+    m_lastAttempt.start();
+    m_page->load(m_homeUrl);
+}
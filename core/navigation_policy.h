@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+class QWebEnginePage;
+
+// 播放页的导航策略：页面离开允许的域名或播放页加载失败时回到播放页，代替直接在 urlChanged 里重新加载。
+//   - 允许的域名：播放页域名与登录流程用到的第三方域名（按后缀匹配子域名），可用 navigation/allowedHosts 追加；
+//   - 回退：第一次立即返回，之后按 kInitialRetryDelayMs 起倍增延迟（最多 kMaxRetryDelayMs），
+//     距上次尝试超过 kStableAfterMs 后重新计数，避免重定向循环反复加载；
+//   - 离线：QNetworkInformation 报告断网或处于强制门户（captive portal）之后时暂停重新加载，网络恢复后立即返回播放页。
+// 计数记录在 Metrics 的 navigation_* 中。
+class NavigationPolicy : public QObject {
+    Q_OBJECT
+
+public:
+    NavigationPolicy(QWebEnginePage *page, const QUrl &homeUrl, QObject *parent = nullptr);
+
+    void addAllowedHost(const QString &host) { m_allowedHosts.insert(host.toLower()); }
+
+    bool isAllowed(const QUrl &url) const;
+
+    // 没有可用的网络状态后端时视为在线
+    static bool isOnline();
+
+private:
+    void onUrlChanged(const QUrl &url);
+    void onLoadFinished(bool ok);
+    void onNetworkChanged();
+    void scheduleReturn(const char *reason);
+    void returnHome();
+
+    static constexpr int kInitialRetryDelayMs = 1000;
+    static constexpr int kMaxRetryDelayMs = 5 * 60 * 1000;
+    static constexpr int kStableAfterMs = 60 * 1000;
+
+    QWebEnginePage *m_page;
+    QUrl m_homeUrl;
+    QSet<QString> m_allowedHosts;
+    int m_attempts = 0;
+    // 离线期间需要返回播放页，等网络恢复
+    bool m_pending = false;
+    QElapsedTimer m_lastAttempt;
+    QTimer m_retryTimer;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+
+// 通过 QWebChannel 暴露给媒体控制桥的宿主对象（页面中名为 cmwHost）。
+// 桥在 <audio> 状态变化时调用 pushState，连接建立时调用 hello；
+// 页面开始重新加载时连接自然失效，由 resetConnection 标记。
+class PlaybackStateChannel : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PlaybackStateChannel(QObject *parent = nullptr) : QObject(parent) {}
+
+    bool isConnected() const { return m_connected; }
+
+    void resetConnection() { setConnected(false); }
+
+    Q_INVOKABLE void hello() { setConnected(true); }
+
+    // state 为 __cmw.state() 的 JSON 字符串
+    Q_INVOKABLE void pushState(const QString &state) {
+        setConnected(true);
+        emit stateReceived(state);
+    }
+
+    // 播放中缓冲耗尽（waiting）到恢复播放的时长，seek 和曲目开头的缓冲不计
+    Q_INVOKABLE void reportStall(int durationMs) { emit stallReported(durationMs); }
+
+    // result 为 JSON 字符串 {ok, reason, totalMs, readyDelayMs}
+    Q_INVOKABLE void restoreFinished(const QString &result) {
+        emit restoreReported(QJsonDocument::fromJson(result.toUtf8()).object());
+    }
+
+signals:
+    void connectedChanged(bool connected);
+    void stateReceived(const QString &state);
+    void restoreReported(const QJsonObject &result);
+    void stallReported(int durationMs);
+
+private:
+    void setConnected(bool connected) {
+        if (m_connected == connected) return;
+        m_connected = connected;
+        emit connectedChanged(connected);
+    }
+
+    bool m_connected = false;
+};
@@ -0,0 +1,42 @@
+#include "player_bridge.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QWebEnginePage>
+#include <QWebEngineScriptCollection>
+
+// 读取资源中的脚本，读取失败时返回空字符串
+static QString readScriptResource(const QString &path) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return QString();
+    return QString::fromUtf8(f.readAll());
+}
+
+void installPlayerBridge(QWebEnginePage *page) {
+    // qwebchannel.js 由 Qt WebChannel 模块以资源形式提供，需与桥位于同一个 world
+    static const QString channelSource = readScriptResource(":/qtwebchannel/qwebchannel.js");
+    if (!channelSource.isEmpty()) {
+        QWebEngineScript channelScript;
+        channelScript.setName("cmw-qwebchannel");
+        channelScript.setSourceCode(channelSource);
+        channelScript.setInjectionPoint(QWebEngineScript::DocumentCreation);
+        channelScript.setWorldId(kBridgeWorldId);
+        channelScript.setRunsOnSubFrames(false);
+        page->scripts().insert(channelScript);
+    } else {
+        qWarning() << "qwebchannel.js not available, playback state push disabled";
+    }
+
+    static const QString bridgeSource = readScriptResource(":/cmw/js/bridge.js");
+    if (bridgeSource.isEmpty()) {
+        qWarning() << "Media bridge resource missing, player controls disabled";
+        return;
+    }
+    QWebEngineScript script;
+    script.setName("cmw-bridge");
+    script.setSourceCode(bridgeSource);
+    script.setInjectionPoint(QWebEngineScript::DocumentReady);
+    script.setWorldId(kBridgeWorldId);
+    script.setRunsOnSubFrames(false);
+    page->scripts().insert(script);
+}
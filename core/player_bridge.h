@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QWebEngineScript>
+
+class QWebEnginePage;
+
+// 媒体控制桥所在的 JS world，所有 __cmw 调用都必须在该 world 中执行
+static constexpr quint32 kBridgeWorldId = QWebEngineScript::ApplicationWorld;
+
+// 把 QWebChannel 客户端库和媒体控制桥注册到 page 的脚本集合中，之后每次加载新文档都会自动注入。
+// 桥的源码（resources/js/bridge.js）以 Qt 资源形式编译进 cloudmusic_core
+void installPlayerBridge(QWebEnginePage *page);
@@ -0,0 +1,133 @@
+#include "player_command.h"
+
+#include "metrics.h"
+#include "player_bridge.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QWebEnginePage>
+
+const char *playerCommandName(PlayerCommand cmd) {
+    switch (cmd) {
+        case PlayerCommand::PlayPause: return "PlayPause";
+        case PlayerCommand::Play: return "Play";
+        case PlayerCommand::Pause: return "Pause";
+        case PlayerCommand::Previous: return "Previous";
+        case PlayerCommand::Next: return "Next";
+        case PlayerCommand::Seek: return "Seek";
+        case PlayerCommand::SeekBy: return "SeekBy";
+    }
+    return "Unknown";
+}
+
+QString playerCommandKey(PlayerCommand cmd) {
+    switch (cmd) {
+        case PlayerCommand::PlayPause: return "playPause";
+        case PlayerCommand::Play: return "play";
+        case PlayerCommand::Pause: return "pause";
+        case PlayerCommand::Previous: return "prev";
+        case PlayerCommand::Next: return "next";
+        case PlayerCommand::Seek: return "seek";
+        case PlayerCommand::SeekBy: return "seekBy";
+    }
+    return QString();
+}
+
+bool playerCommandFromKey(const QString &key, PlayerCommand *cmd) {
+    for (PlayerCommand c : {PlayerCommand::PlayPause, PlayerCommand::Play, PlayerCommand::Pause, PlayerCommand::Previous,
+                            PlayerCommand::Next, PlayerCommand::Seek, PlayerCommand::SeekBy}) {
+        if (playerCommandKey(c) == key) {
+            *cmd = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool playerCommandHasValue(PlayerCommand cmd) {
+    return cmd == PlayerCommand::Seek || cmd == PlayerCommand::SeekBy;
+}
+
+PlayerCommandDispatcher::PlayerCommandDispatcher(QWebEnginePage *page, QObject *parent)
+    : QObject(parent), m_page(page) {
+    m_timeoutTimer.setSingleShot(true);
+    m_timeoutTimer.setInterval(1200);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, [this]() {
+        qWarning() << "Player command batch timed out";
+        finishBatch(m_batchId, QVariant());
+    });
+}
+
+void PlayerCommandDispatcher::setPage(QWebEnginePage *page) {
+    m_page = page;
+    if (m_inFlight.isEmpty()) sendNextBatch();
+}
+
+void PlayerCommandDispatcher::dispatch(PlayerCommand cmd, double value, Callback done) {
+    Pending p;
+    p.cmd = cmd;
+    p.value = value;
+    p.done = std::move(done);
+    p.timer.start();
+    m_queue.append(std::move(p));
+    if (m_inFlight.isEmpty()) sendNextBatch();
+}
+
+void PlayerCommandDispatcher::sendNextBatch() {
+    if (m_queue.isEmpty() || !m_page) return;
+
+    // 托盘模式下页面可能被冻结，冻结的页面不会执行脚本
+    if (m_page->lifecycleState() == QWebEnginePage::LifecycleState::Frozen)
+        m_page->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+
+    const int count = qMin<int>(m_queue.size(), kMaxBatchSize);
+    QJsonArray batch;
+    for (int i = 0; i < count; ++i) {
+        const Pending &p = m_queue.first();
+        if (playerCommandHasValue(p.cmd)) batch.append(QJsonArray{playerCommandKey(p.cmd), p.value});
+        else batch.append(playerCommandKey(p.cmd));
+        m_inFlight.append(m_queue.takeFirst());
+    }
+
+    // 只发送很短的桥调用；桥尚未注入时返回 null，整批视为失败
+    const QString js = QStringLiteral("window.__cmw ? __cmw.run(%1) : null")
+                       .arg(QString::fromUtf8(QJsonDocument(batch).toJson(QJsonDocument::Compact)));
+
+    const quint64 batchId = ++m_batchId;
+    QPointer<PlayerCommandDispatcher> self(this);
+    runJavaScriptTimed(m_page, "run", js, kBridgeWorldId, [self, batchId](const QVariant &v) {
+        if (self) self->finishBatch(batchId, v);
+    });
+    m_timeoutTimer.start();
+}
+
+void PlayerCommandDispatcher::finishBatch(quint64 batchId, const QVariant &result) {
+    // 超时后才返回的结果属于已经结束的批次，直接丢弃
+    if (batchId != m_batchId || m_inFlight.isEmpty()) return;
+    m_timeoutTimer.stop();
+
+    const QVariantMap reply = result.toMap();
+    const QVariantList results = reply.value("results").toList();
+    if (reply.contains("cache")) {
+        const QVariantMap cache = reply.value("cache").toMap();
+        m_cacheStats.hits = cache.value("hits").toLongLong();
+        m_cacheStats.misses = cache.value("misses").toLongLong();
+        m_cacheStats.invalidations = cache.value("invalidations").toLongLong();
+    }
+    QList<Pending> finished;
+    finished.swap(m_inFlight);
+    for (int i = 0; i < finished.size(); ++i) {
+        Pending &p = finished[i];
+        const bool ok = i < results.size() && results.at(i).toBool();
+        const qint64 latency = p.timer.elapsed();
+        Metrics::instance().addSample(QString("command.") + playerCommandName(p.cmd), latency);
+        qDebug().nospace() << "Player command " << playerCommandName(p.cmd)
+                           << (ok ? " ok" : " failed") << " in " << latency << " ms"
+                           << " (element cache hits " << m_cacheStats.hits
+                           << ", misses " << m_cacheStats.misses << ")";
+        if (p.done) p.done(ok, latency);
+    }
+
+    sendNextBatch();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+
+#include <functional>
+
+class QWebEnginePage;
+
+// 托盘/快捷操作对应的播放器命令
+// Seek 的参数为绝对位置（秒），SeekBy 为相对偏移（秒）
+enum class PlayerCommand { PlayPause, Play, Pause, Previous, Next, Seek, SeekBy };
+
+const char *playerCommandName(PlayerCommand cmd);
+
+// 命令在 __cmw 中对应的名字（同时用作 IPC 协议中的命令名）
+QString playerCommandKey(PlayerCommand cmd);
+
+// playerCommandKey 的逆映射，未知名字返回 false
+bool playerCommandFromKey(const QString &key, PlayerCommand *cmd);
+
+bool playerCommandHasValue(PlayerCommand cmd);
+
+// 异步播放器命令分发器：调用方只负责入队，不会在 GUI 线程上阻塞等待 JS 结果。
+// 同一时间最多只有一个批次在页面中执行；执行期间到达的命令排队，
+// 上一批完成后合并为一个有序批次，通过一次 runJavaScript 下发。
+// 每条命令完成（或超时）后通过回调报告结果与从入队到完成的耗时。
+class PlayerCommandDispatcher : public QObject {
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(bool ok, qint64 latencyMs)>;
+
+    // 页面内按钮元素缓存的累计计数，每个批次返回时更新
+    struct CacheStats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 invalidations = 0;
+    };
+
+    explicit PlayerCommandDispatcher(QWebEnginePage *page, QObject *parent = nullptr);
+
+    // 页面尚未创建时入队的命令会保留，直到 setPage 后再下发
+    void setPage(QWebEnginePage *page);
+
+    void dispatch(PlayerCommand cmd, Callback done = {}) { dispatch(cmd, 0.0, std::move(done)); }
+
+    // 带参数的命令（Seek / SeekBy）
+    void dispatch(PlayerCommand cmd, double value, Callback done = {});
+
+    // 单个批次的最长等待时间，超时后该批次内的命令均视为失败
+    void setTimeout(int timeoutMs) { m_timeoutTimer.setInterval(timeoutMs); }
+
+    // 最近一次得到的元素缓存计数（页面重新加载后从 0 开始）
+    CacheStats cacheStats() const { return m_cacheStats; }
+
+private:
+    struct Pending {
+        PlayerCommand cmd;
+        double value = 0.0;
+        Callback done;
+        QElapsedTimer timer;
+    };
+
+    void sendNextBatch();
+    void finishBatch(quint64 batchId, const QVariant &result);
+
+    static constexpr int kMaxBatchSize = 16;
+
+    QPointer<QWebEnginePage> m_page;
+    QList<Pending> m_queue;
+    QList<Pending> m_inFlight;
+    QTimer m_timeoutTimer;
+    quint64 m_batchId = 0;
+    CacheStats m_cacheStats;
+};
@@ -0,0 +1,168 @@
+#include "player_controller.h"
+
+#include "media_session.h"
+#include "metadata_cache.h"
+#include "metrics.h"
+#include "navigation_policy.h"
+#include "playback_state_channel.h"
+#include "player_bridge.h"
+#include "player_command.h"
+#include "process_stats.h"
+#include "renderer_supervisor.h"
+#include "state_store.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QWebChannel>
+#include <QWebEnginePage>
+
+PlayerController::PlayerController(const QString &stateFilePath, QObject *parent)
+    : QObject(parent), m_pollTimer("state.poll", ScheduledJob::Urgent) {
+    QElapsedTimer stateLoadTimer;
+    stateLoadTimer.start();
+    m_stateStore = new StateStore(stateFilePath, this);
+    Metrics::instance().addSample("state_load", stateLoadTimer.elapsed());
+
+    // 页面在 WebEngine 初始化后才设置，此前的命令会排队等待
+    m_dispatcher = new PlayerCommandDispatcher(nullptr, this);
+    // 系统媒体控制（MPRIS 等）共用的媒体会话，由推送的播放状态驱动
+    m_session = new MediaSession(m_dispatcher, this);
+    m_stateChannel = new PlaybackStateChannel(this);
+
+    m_pollTimer.setInterval(4000); // 4s
+    connect(&m_pollTimer, &ScheduledJob::timeout, this, &PlayerController::pollState);
+
+    // 主路径：页面通过 QWebChannel 推送状态变化
+    connect(m_stateChannel, &PlaybackStateChannel::stateReceived, this, [this](const QString &json) {
+        persistState(json);
+        const QJsonObject state = QJsonDocument::fromJson(json.toUtf8()).object();
+        const QString previousId = m_session->trackId();
+        m_session->updateFromState(state);
+        if (!m_metadata) return;
+        m_metadata->observe(state);
+        if (m_session->trackId() != previousId) applyTrackDetails(m_session->trackId());
+    });
+    connect(m_stateChannel, &PlaybackStateChannel::connectedChanged, this, [this](bool connected) {
+        if (connected) m_pollTimer.stop();
+        else if (m_page) m_pollTimer.start();
+    });
+    // 页面在 seek 完成（或超时放弃）后报告恢复结果
+    connect(m_stateChannel, &PlaybackStateChannel::restoreReported, this, &PlayerController::finishRestore);
+    connect(m_stateChannel, &PlaybackStateChannel::stallReported, this, &PlayerController::stallReported);
+}
+
+void PlayerController::attachPage(QWebEnginePage *page) {
+    m_page = page;
+    installPlayerBridge(page);
+    QWebChannel *webChannel = new QWebChannel(page);
+    webChannel->registerObject("cmwHost", m_stateChannel);
+    page->setWebChannel(webChannel, kBridgeWorldId);
+    m_dispatcher->setPage(page);
+
+    // 离开播放页（登录流程除外）或加载失败时带回退地回到播放页，离线时暂停
+    new NavigationPolicy(page, playerUrl(), page);
+
+    connect(page, &QWebEnginePage::loadStarted, m_stateChannel, &PlaybackStateChannel::resetConnection);
+    connect(page, &QWebEnginePage::loadStarted, this, []() { Metrics::instance().mark("load_started"); });
+    connect(page, &QWebEnginePage::loadFinished, this, [this](bool ok) {
+        Metrics::instance().mark(ok ? "load_finished" : "load_failed");
+        if (ok) restoreState();
+    });
+    if (!m_stateChannel->isConnected()) m_pollTimer.start();
+    new RendererSupervisor(this, page, page);
+}
+
+void PlayerController::setMetadataCache(MetadataCache *cache) {
+    m_metadata = cache;
+    connect(cache, &MetadataCache::trackUpdated, this, &PlayerController::applyTrackDetails);
+}
+
+void PlayerController::applyTrackDetails(const QString &id) {
+    if (!m_metadata || id.isEmpty() || id != m_session->trackId() || !m_metadata->contains(id)) return;
+    const MetadataCache::Track track = m_metadata->track(id);
+    m_session->setTrackDetails(id, track.title, track.artist, track.album, m_metadata->artFile(id),
+                               m_metadata->lyrics(id));
+}
+
+void PlayerController::load() {
+    if (m_page) m_page->load(playerUrl());
+}
+
+void PlayerController::shutdown() {
+    m_pollTimer.stop();
+    m_stateStore->flush();
+    if (m_metadata) m_metadata->saveIndex();
+
+    // 退出时的累计 CPU 时间和常驻内存，用于比较窗口模式与无界面模式的开销（不支持的平台不记录）
+    Metrics &metrics = Metrics::instance();
+    const auto recordProcess = [&metrics](const QString &name, qint64 pid) {
+        const qint64 cpuMs = processCpuTimeMs(pid);
+        if (cpuMs >= 0) metrics.increment("cpu_ms." + name, cpuMs);
+        const qint64 residentBytes = processResidentBytes(pid);
+        if (residentBytes >= 0) metrics.increment("rss_kb." + name, residentBytes / 1024);
+    };
+    recordProcess("browser", QCoreApplication::applicationPid());
+    if (m_page && m_page->renderProcessPid() > 0) recordProcess("renderer", m_page->renderProcessPid());
+}
+
+void PlayerController::persistState(const QString &json) {
+    if (json.isEmpty()) return;
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        qWarning() << "Ignoring malformed player state:" << err.errorString();
+        return;
+    }
+    m_stateStore->update(doc.object());
+}
+
+void PlayerController::pollState() {
+    if (!m_page) return;
+    QPointer<PlayerController> self(this);
+    runJavaScriptTimed(m_page, "state", QStringLiteral("window.__cmw ? __cmw.state() : null"), kBridgeWorldId,
+                       [self](const QVariant &result) {
+        if (!self || !result.isValid()) return;
+        self->persistState(result.toString());
+    });
+}
+
+void PlayerController::restoreState() {
+    const QJsonObject obj = m_stateStore->current();
+    if (obj.value("id").toString().isEmpty()) return;
+    QJsonObject current;
+    current["id"] = obj.value("id").toString();
+    current["time"] = obj.value("time").toDouble(0.0);
+    current["paused"] = obj.value("paused").toBool(true);
+    current["duration"] = obj.value("duration").toDouble(0.0);
+    QJsonObject saved;
+    saved["current"] = current;
+    saved["recent"] = m_stateStore->recent();
+    const QString js = QStringLiteral("window.__cmw ? __cmw.restore(%1) : false")
+                       .arg(QString::fromUtf8(QJsonDocument(saved).toJson(QJsonDocument::Compact)));
+    m_stateStore->beginRestore();
+    QPointer<PlayerController> self(this);
+    runJavaScriptTimed(m_page, "restore", js, kBridgeWorldId, [self](const QVariant &v) {
+        if (!self || v.toBool()) return;
+        self->m_stateStore->endRestore();
+        qWarning() << "State restore could not be started";
+        emit self->restoreFinished(false);
+    });
+}
+
+void PlayerController::finishRestore(const QJsonObject &result) {
+    m_stateStore->endRestore();
+    Metrics &metrics = Metrics::instance();
+    const bool ok = result.value("ok").toBool();
+    const qint64 totalMs = result.value("totalMs").toInteger();
+    metrics.increment(ok ? "restore_ok" : "restore_failed");
+    if (ok) {
+        metrics.addSample("state_restore", totalMs);
+        metrics.addSample("state_restore_ready_delay", result.value("readyDelayMs").toInteger());
+        qDebug() << "State restored in" << totalMs << "ms";
+    } else {
+        qWarning() << "State restore failed:" << result.value("reason").toString() << "after" << totalMs << "ms";
+    }
+    emit restoreFinished(ok);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "power_scheduler.h"
+
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QUrl>
+
+class MediaSession;
+class MetadataCache;
+class PlaybackStateChannel;
+class PlayerCommandDispatcher;
+class QWebEnginePage;
+class StateStore;
+
+// 播放器控制核心，与界面无关：命令下发（PlayerCommandDispatcher）、页面推送的播放状态（MediaSession）、
+// 状态持久化（StateStore），以及每次页面加载完成后的状态恢复。
+// 主窗口、托盘、IPC 和 MPRIS 都只与它交互；页面可以稍后 attachPage，此前的命令会排队。
+// 渲染进程意外退出时由 RendererSupervisor 重新加载页面并恢复状态。
+class PlayerController : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PlayerController(const QString &stateFilePath, QObject *parent = nullptr);
+
+    static QUrl playerUrl() { return QUrl("https://music.163.com/st/webplayer"); }
+
+    PlayerCommandDispatcher *dispatcher() const { return m_dispatcher; }
+    MediaSession *session() const { return m_session; }
+    StateStore *stateStore() const { return m_stateStore; }
+    QWebEnginePage *page() const { return m_page; }
+    MetadataCache *metadataCache() const { return m_metadata; }
+
+    // 播放状态同时交给元数据缓存，缓存补全的详情、歌词与本地封面再写回 MediaSession
+    void setMetadataCache(MetadataCache *cache);
+
+    // 接管 page：注入媒体控制桥，建立 QWebChannel 推送通道，加载完成后恢复保存的状态。
+    // 页面离开允许的域名时由 NavigationPolicy 带回播放页
+    void attachPage(QWebEnginePage *page);
+
+    // 加载播放页
+    void load();
+
+    // 退出前调用：停止兜底轮询并把状态同步落盘
+    void shutdown();
+
+signals:
+    // 页面报告状态恢复结束（或无法开始恢复）
+    void restoreFinished(bool ok);
+    // 页面报告的播放卡顿时长（见 PlaybackStateChannel）
+    void stallReported(int durationMs);
+
+private:
+    void persistState(const QString &json);
+    void pollState();
+    void restoreState();
+    void finishRestore(const QJsonObject &result);
+    void applyTrackDetails(const QString &id);
+
+    StateStore *m_stateStore;
+    PlayerCommandDispatcher *m_dispatcher;
+    MediaSession *m_session;
+    PlaybackStateChannel *m_stateChannel;
+    MetadataCache *m_metadata = nullptr;
+    QPointer<QWebEnginePage> m_page;
+    // 兜底：推送通道未建立（如 qwebchannel.js 不可用）时才轮询
+    ScheduledJob m_pollTimer;
+};
@@ -0,0 +1,56 @@
+#include "player_profile.h"
+
+#include "cache_policy.h"
+#include "media_cache.h"
+#include "metrics.h"
+#include "request_blocker.h"
+#include "storage_maintenance.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSettings>
+#include <QWebEnginePage>
+#include <QWebEngineProfile>
+#include <QWebEngineSettings>
+
+PlayerProfile createPlayerProfile(const QString &dataDir, QObject *parent) {
+    PlayerProfile result;
+    // 上次维护标记为超限的存储只能在 profile 打开之前删除
+    StorageMaintenance::pruneMarkedStores(dataDir + "/storage");
+    QWebEngineProfile *profile = new QWebEngineProfile("CloudMusicWebPlayer-Qt", parent);
+    result.profile = profile;
+    profile->setPersistentStoragePath(dataDir + "/storage");
+    applyHttpCachePolicy(profile, dataDir + "/cache");
+    profile->setPersistentCookiesPolicy(QWebEngineProfile::ForcePersistentCookies);
+    profile->setHttpUserAgent(QString::fromLatin1(kPlayerUserAgent));
+
+    RequestBlocker *blocker = new RequestBlocker(profile);
+    const int userRules = blocker->loadRules(dataDir + "/blocklist.txt");
+    if (userRules > 0) qDebug() << "Loaded" << userRules << "request blocking rules," << blocker->ruleCount() << "in total";
+    profile->setUrlRequestInterceptor(blocker);
+
+    {
+        QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+        const qint64 maxBytes = settings.value("mediaCache/maxSizeMB", 1024).toLongLong() * 1024 * 1024;
+        if (maxBytes > 0) {
+            result.mediaCache = new MediaCache(dataDir + "/media", maxBytes, profile);
+            result.mediaCache->setMinPlays(settings.value("mediaCache/minPlays", 2).toInt());
+            profile->installUrlSchemeHandler(kMediaCacheScheme, new MediaSchemeHandler(result.mediaCache, profile));
+            QObject::connect(qApp, &QCoreApplication::aboutToQuit, result.mediaCache, &MediaCache::saveIndex);
+        }
+    }
+
+    // 注意：某些 Qt 版本没有 ServiceWorkersEnabled 枚举，故不调用该属性以保证兼容性
+    profile->settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
+    profile->settings()->setAttribute(QWebEngineSettings::LocalStorageEnabled, true);
+    profile->settings()->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, true);
+    profile->settings()->setAttribute(QWebEngineSettings::PluginsEnabled, true);
+    Metrics::instance().mark("profile_ready");
+    return result;
+}
+
+QWebEnginePage *createPlayerPage(const PlayerProfile &profile, QObject *parent) {
+    QWebEnginePage *page = new QWebEnginePage(profile.profile, parent);
+    if (profile.mediaCache) page->setUrlRequestInterceptor(new MediaCacheInterceptor(profile.mediaCache, page));
+    return page;
+}
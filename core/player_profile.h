@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QString>
+
+class MediaCache;
+class QObject;
+class QWebEngineProfile;
+class QWebEnginePage;
+
+// 播放器使用的持久化 profile 及挂在它上面的音频缓存（mediaCache/maxSizeMB 为 0 时为空）
+struct PlayerProfile {
+    QWebEngineProfile *profile = nullptr;
+    MediaCache *mediaCache = nullptr;
+};
+
+// 在 dataDir 下创建播放器 profile：存储与 HTTP 缓存路径、User-Agent、请求屏蔽、音频缓存
+PlayerProfile createPlayerProfile(const QString &dataDir, QObject *parent);
+
+// 在 profile 上创建播放页，并安装音频缓存拦截器
+QWebEnginePage *createPlayerPage(const PlayerProfile &profile, QObject *parent);
@@ -0,0 +1,285 @@
+#include "power_scheduler.h"
+
+#include "metrics.h"
+#include "trace_recorder.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QPointer>
+#include <QSettings>
+
+#if defined(CMW_HAVE_DBUS)
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+#endif
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace {
+
+#if defined(CMW_HAVE_DBUS)
+const char kUPowerService[] = "org.freedesktop.UPower";
+const char kUPowerPath[] = "/org/freedesktop/UPower";
+#endif
+
+#if defined(Q_OS_LINUX)
+QString readSysfs(const QString &path) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return QString();
+    return QString::fromLatin1(f.readAll()).trimmed();
+}
+#endif
+
+// 没有电源通知时直接读取系统电源状态
+bool systemOnBattery() {
+#if defined(Q_OS_WIN)
+    SYSTEM_POWER_STATUS status;
+    return GetSystemPowerStatus(&status) && status.ACLineStatus == 0;
+#elif defined(Q_OS_LINUX)
+    // 有外接电源（Mains，或 USB-C 供电）时以它是否在线为准；台式机等没有外接电源条目时看电池是否在放电
+    const QDir dir("/sys/class/power_supply");
+    bool hasLinePower = false;
+    bool linePowerOnline = false;
+    bool discharging = false;
+    for (const QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const QString type = readSysfs(dir.filePath(name + "/type"));
+        if (type == "Mains" || type == "USB") {
+            hasLinePower = true;
+            if (readSysfs(dir.filePath(name + "/online")) == "1") linePowerOnline = true;
+        } else if (type == "Battery" && readSysfs(dir.filePath(name + "/status")) == "Discharging") {
+            discharging = true;
+        }
+    }
+    return hasLinePower ? !linePowerOnline : discharging;
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+PowerScheduler &PowerScheduler::instance() {
+    // 故意不释放：任务可能在 QCoreApplication 之后才析构，仍需要注销
+    static PowerScheduler *scheduler = new PowerScheduler;
+    return *scheduler;
+}
+
+PowerScheduler::PowerScheduler(QObject *parent) : QObject(parent) {
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &PowerScheduler::tick);
+
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    const QString mode = settings.value("power/mode", "auto").toString();
+    if (mode == "normal") m_mode = Mode::Normal;
+    else if (mode == "saving") m_mode = Mode::Saving;
+
+    updateSaving();
+    // 第一个任务在启动路径上（StateStore 构造时）创建调度器；连接系统总线等留到事件循环开始后
+    QMetaObject::invokeMethod(this, &PowerScheduler::watchPowerSource, Qt::QueuedConnection);
+}
+
+void PowerScheduler::watchPowerSource() {
+#if defined(CMW_HAVE_DBUS)
+    // 只订阅变化通知并异步读取当前值，不创建同步的 QDBusInterface（内省和属性读取都是阻塞调用）
+    QDBusConnection bus = QDBusConnection::systemBus();
+    if (bus.isConnected()) {
+        m_powerNotifications = bus.connect(kUPowerService, kUPowerPath, "org.freedesktop.DBus.Properties",
+                                           "PropertiesChanged", this,
+                                           SLOT(onUPowerChanged(QString, QVariantMap, QStringList)));
+    }
+    if (m_powerNotifications) {
+        QDBusMessage get = QDBusMessage::createMethodCall(kUPowerService, kUPowerPath,
+                                                          "org.freedesktop.DBus.Properties", "Get");
+        get << QString::fromLatin1(kUPowerService) << QString("OnBattery");
+        auto *watcher = new QDBusPendingCallWatcher(bus.asyncCall(get), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *call) {
+            call->deleteLater();
+            const QDBusPendingReply<QDBusVariant> reply = *call;
+            if (reply.isError()) {
+                // 没有 UPower（或无权访问）：改为读取系统电源状态
+                qDebug() << "UPower unavailable:" << reply.error().message();
+                QDBusConnection::systemBus().disconnect(kUPowerService, kUPowerPath, "org.freedesktop.DBus.Properties",
+                                                        "PropertiesChanged", this,
+                                                        SLOT(onUPowerChanged(QString, QVariantMap, QStringList)));
+                m_powerNotifications = false;
+                pollPowerSource();
+                return;
+            }
+            setOnBattery(reply.value().variant().toBool());
+        });
+        return;
+    }
+#endif
+    pollPowerSource();
+}
+
+#if defined(CMW_HAVE_DBUS)
+void PowerScheduler::onUPowerChanged(const QString &interfaceName, const QVariantMap &changed,
+                                     const QStringList &invalidated) {
+    Q_UNUSED(invalidated);
+    if (interfaceName != QLatin1String(kUPowerService) || !changed.contains("OnBattery")) return;
+    setOnBattery(changed.value("OnBattery").toBool());
+}
+#endif
+
+void PowerScheduler::pollPowerSource() {
+    if (m_lastPowerPoll.isValid() && m_lastPowerPoll.elapsed() < kPowerPollMs) return;
+    m_lastPowerPoll.start();
+    setOnBattery(systemOnBattery());
+}
+
+void PowerScheduler::setOnBattery(bool onBattery) {
+    if (m_onBattery == onBattery) return;
+    m_onBattery = onBattery;
+    updateSaving();
+}
+
+void PowerScheduler::setIdle(bool idle) {
+    if (m_idle == idle) return;
+    m_idle = idle;
+    updateSaving();
+}
+
+void PowerScheduler::updateSaving() {
+    const bool saving = m_mode == Mode::Saving || (m_mode == Mode::Auto && (m_onBattery || m_idle));
+    if (saving == m_saving) return;
+    const qint64 t = now();
+    if (saving) {
+        m_savingSince = t;
+    } else {
+        m_savingMs += t - m_savingSince;
+        m_savingSince = -1;
+    }
+    m_saving = saving;
+    qInfo().nospace() << "Power saving " << (saving ? "on" : "off") << " (on battery: " << m_onBattery
+                      << ", idle: " << m_idle << "), " << wakeupsPerMinute() << " wakeups/min so far";
+    updateMetrics();
+    emit savingChanged(saving);
+    reschedule();
+}
+
+double PowerScheduler::wakeupsPerMinute() const {
+    const qint64 elapsed = now();
+    return elapsed > 0 ? m_wakeups * 60000.0 / elapsed : 0.0;
+}
+
+void PowerScheduler::updateMetrics() {
+    // 计数只能是整数，唤醒频率按每小时记录（每分钟 = 每小时 / 60）
+    const auto perHour = [](qint64 wakeups, qint64 ms) { return ms > 0 ? wakeups * 3600000 / ms : 0; };
+    const qint64 total = now();
+    const qint64 savingMs = m_savingMs + (m_savingSince >= 0 ? total - m_savingSince : 0);
+    Metrics &metrics = Metrics::instance();
+    metrics.setCounter("scheduler_wakeups", m_wakeups);
+    metrics.setCounter("scheduler_saving_ms", savingMs);
+    metrics.setCounter("scheduler_wakeups_per_hour", perHour(m_wakeups, total));
+    metrics.setCounter("scheduler_wakeups_per_hour.normal", perHour(m_wakeups - m_savingWakeups, total - savingMs));
+    metrics.setCounter("scheduler_wakeups_per_hour.saving", perHour(m_savingWakeups, savingMs));
+}
+
+void PowerScheduler::add(ScheduledJob *job) {
+    m_jobs.append(job);
+}
+
+void PowerScheduler::remove(ScheduledJob *job) {
+    m_jobs.removeOne(job);
+    if (m_jobs.isEmpty()) {
+        m_timer.stop();
+        return;
+    }
+    // 未启动的任务不影响下一次唤醒；退出过程中析构的任务不再重新安排（reschedule 本身也会跳过）
+    if (job->isActive()) reschedule();
+}
+
+qint64 PowerScheduler::dueTime(const ScheduledJob *job) const {
+    qint64 interval = job->m_intervalMs;
+    if (m_saving && job->m_urgency == ScheduledJob::Deferrable) interval *= kDeferFactor;
+    return job->m_startedAt + interval;
+}
+
+void PowerScheduler::reschedule() {
+    // tick() 执行完所有到期任务后统一重新计算
+    if (m_inTick) return;
+    // 调度器故意不释放，QCoreApplication 析构期间（对象逐个析构、任务注销时）不能再启动定时器
+    if (QCoreApplication::closingDown()) {
+        m_timer.stop();
+        return;
+    }
+    qint64 next = -1;
+    for (const ScheduledJob *job : std::as_const(m_jobs)) {
+        if (!job->isActive()) continue;
+        const qint64 due = dueTime(job);
+        if (next < 0 || due < next) next = due;
+    }
+    if (next < 0) {
+        m_timer.stop();
+        return;
+    }
+    // 省电模式下对齐到共享的节拍，不同任务落在同一次唤醒里
+    if (m_saving) next = (next + kTickMs - 1) / kTickMs * kTickMs;
+    m_timer.setTimerType(m_saving ? Qt::VeryCoarseTimer : Qt::CoarseTimer);
+    m_timer.start(int(qMax<qint64>(0, next - now())));
+}
+
+void PowerScheduler::tick() {
+    ++m_wakeups;
+    if (m_saving) ++m_savingWakeups;
+    if (!m_powerNotifications) pollPowerSource();
+
+    const qint64 t = now();
+    QList<QPointer<ScheduledJob>> due;
+    for (ScheduledJob *job : std::as_const(m_jobs)) {
+        if (job->isActive() && dueTime(job) <= t + kSlackMs) due.append(job);
+    }
+    m_inTick = true;
+    for (const QPointer<ScheduledJob> &job : std::as_const(due)) {
+        // 之前执行的任务可能已经停止或删除了它
+        if (!job || !job->isActive()) continue;
+        job->m_startedAt = job->m_singleShot ? -1 : t;
+        emit job->timeout();
+    }
+    m_inTick = false;
+    TraceRecorder::instance().instant("scheduler", "scheduler.tick", due.size());
+    updateMetrics();
+    reschedule();
+}
+
+ScheduledJob::ScheduledJob(const QString &name, Urgency urgency, QObject *parent)
+    : QObject(parent), m_name(name), m_urgency(urgency) {
+    PowerScheduler::instance().add(this);
+}
+
+ScheduledJob::~ScheduledJob() {
+    PowerScheduler::instance().remove(this);
+}
+
+void ScheduledJob::setInterval(int intervalMs) {
+    m_intervalMs = intervalMs;
+    // 与 QTimer 相同：运行中修改间隔会重新开始计时
+    if (isActive()) start();
+}
+
+void ScheduledJob::start() {
+    PowerScheduler &scheduler = PowerScheduler::instance();
+    m_startedAt = scheduler.now();
+    scheduler.reschedule();
+}
+
+void ScheduledJob::start(int intervalMs) {
+    m_intervalMs = intervalMs;
+    start();
+}
+
+void ScheduledJob::stop() {
+    if (!isActive()) return;
+    m_startedAt = -1;
+    PowerScheduler::instance().reschedule();
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+class ScheduledJob;
+
+// 后台周期任务（状态落盘、元数据索引保存、内存采样、存储维护等）的统一调度器。
+// 所有任务共用一个定时器，到期时间相近的任务在同一次唤醒中执行。
+//   - 正常模式：按各任务自己的间隔执行（Qt::CoarseTimer），与各自使用 QTimer 时一致；
+//   - 省电模式（使用电池、系统空闲，或 power/mode 设为 saving）：唤醒对齐到 kTickMs 的整数倍
+//     （Qt::VeryCoarseTimer），可推迟的任务间隔再放大 kDeferFactor 倍。
+// 电源状态来自 UPower 的 OnBattery 通知（Linux，需要 Qt D-Bus），否则定期读取
+// /sys/class/power_supply（Linux）或 GetSystemPowerStatus（Windows）；其他平台视为接通电源。
+// 唤醒次数记录在 scheduler_wakeups* 计数中（见 --metrics）。
+class PowerScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    // power/mode：auto 按电源与空闲状态切换，normal / saving 固定
+    enum class Mode { Auto, Normal, Saving };
+
+    static PowerScheduler &instance();
+
+    Mode mode() const { return m_mode; }
+
+    bool onBattery() const { return m_onBattery; }
+    bool isSaving() const { return m_saving; }
+
+    // 应用层面的空闲提示（例如页面已冻结、无界面模式下没有在播放），空闲时进入省电模式
+    void setIdle(bool idle);
+
+    // 启动以来平均每分钟的唤醒次数
+    double wakeupsPerMinute() const;
+
+    // 把唤醒统计写入 Metrics（每次唤醒和模式切换时也会更新），写出指标前调用
+    void updateMetrics();
+
+signals:
+    void savingChanged(bool saving);
+
+#if defined(CMW_HAVE_DBUS)
+private slots:
+    void onUPowerChanged(const QString &interfaceName, const QVariantMap &changed, const QStringList &invalidated);
+#endif
+
+private:
+    friend class ScheduledJob;
+
+    explicit PowerScheduler(QObject *parent = nullptr);
+
+    qint64 now() const { return m_clock.elapsed(); }
+    void add(ScheduledJob *job);
+    void remove(ScheduledJob *job);
+    // 按当前模式重新计算下一次唤醒
+    void reschedule();
+    qint64 dueTime(const ScheduledJob *job) const;
+    void tick();
+
+    void watchPowerSource();
+    void pollPowerSource();
+    void setOnBattery(bool onBattery);
+    void updateSaving();
+
+    static constexpr int kTickMs = 15000;
+    static constexpr int kDeferFactor = 4;
+    // 提前这么多毫秒到期的任务也在本次唤醒中执行，避免紧接着再唤醒一次
+    static constexpr int kSlackMs = 1000;
+    // 没有电源通知时读取电源状态的最短间隔
+    static constexpr int kPowerPollMs = 60000;
+
+    Mode m_mode = Mode::Auto;
+    bool m_onBattery = false;
+    bool m_idle = false;
+    bool m_saving = false;
+    bool m_powerNotifications = false;
+    bool m_inTick = false;
+    QElapsedTimer m_clock;
+    QElapsedTimer m_lastPowerPoll;
+    QTimer m_timer;
+    QList<ScheduledJob *> m_jobs;
+    qint64 m_wakeups = 0;
+    qint64 m_savingWakeups = 0;
+    qint64 m_savingMs = 0;
+    qint64 m_savingSince = -1;
+};
+
+// 交给 PowerScheduler 调度的定时任务，接口与 QTimer 相同（interval / singleShot / start / stop / timeout）。
+// Urgent 任务在省电模式下只对齐唤醒，Deferrable 任务还会被推迟。
+class ScheduledJob : public QObject {
+    Q_OBJECT
+
+public:
+    enum Urgency { Urgent, Deferrable };
+
+    ScheduledJob(const QString &name, Urgency urgency, QObject *parent = nullptr);
+    ~ScheduledJob() override;
+
+    QString name() const { return m_name; }
+    Urgency urgency() const { return m_urgency; }
+
+    int interval() const { return m_intervalMs; }
+    void setInterval(int intervalMs);
+
+    bool isSingleShot() const { return m_singleShot; }
+    void setSingleShot(bool singleShot) { m_singleShot = singleShot; }
+
+    bool isActive() const { return m_startedAt >= 0; }
+
+    void start();
+    void start(int intervalMs);
+    void stop();
+
+signals:
+    void timeout();
+
+private:
+    friend class PowerScheduler;
+
+    QString m_name;
+    Urgency m_urgency;
+    int m_intervalMs = 0;
+    bool m_singleShot = false;
+    // 调度器时钟下的开始时间，小于 0 表示未启动
+    qint64 m_startedAt = -1;
+};
@@ -0,0 +1,71 @@
+#include "process_stats.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+qint64 processCpuTimeMs(qint64 pid) {
+    if (pid <= 0) return -1;
+#if defined(Q_OS_LINUX)
+    QFile f(QString("/proc/%1/stat").arg(pid));
+    if (!f.open(QIODevice::ReadOnly)) return -1;
+    const QByteArray stat = f.readAll();
+    // comm 字段可能包含空格，从最后一个 ')' 之后开始按空格拆分；utime/stime 是第 14/15 个字段
+    const int commEnd = stat.lastIndexOf(')');
+    if (commEnd < 0) return -1;
+    const QList<QByteArray> fields = stat.mid(commEnd + 2).split(' ');
+    if (fields.size() < 13) return -1;
+    const long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks <= 0) return -1;
+    return (fields.at(11).toLongLong() + fields.at(12).toLongLong()) * 1000 / ticks;
+#elif defined(Q_OS_WIN)
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!h) return -1;
+    FILETIME creation, exit, kernel, user;
+    qint64 result = -1;
+    if (GetProcessTimes(h, &creation, &exit, &kernel, &user)) {
+        auto toMs = [](const FILETIME &ft) {
+            return ((static_cast<qint64>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) / 10000;
+        };
+        result = toMs(kernel) + toMs(user);
+    }
+    CloseHandle(h);
+    return result;
+#else
+    return -1;
+#endif
+}
+
+qint64 processResidentBytes(qint64 pid) {
+    if (pid <= 0) return -1;
+#if defined(Q_OS_LINUX)
+    QFile f(QString("/proc/%1/status").arg(pid));
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+    while (!f.atEnd()) {
+        const QByteArray line = f.readLine();
+        if (line.startsWith("VmRSS:")) {
+            // 形如 "VmRSS:     123456 kB"
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;
+        }
+    }
+    return -1;
+#elif defined(Q_OS_WIN)
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!h) return -1;
+    PROCESS_MEMORY_COUNTERS counters;
+    qint64 result = -1;
+    if (GetProcessMemoryInfo(h, &counters, sizeof(counters))) result = static_cast<qint64>(counters.WorkingSetSize);
+    CloseHandle(h);
+    return result;
+#else
+    return -1;
+#endif
+}
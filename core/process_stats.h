@@ -0,0 +1,9 @@
+#pragma once
+
+#include <QtGlobal>
+
+// 读取进程累计 CPU 时间（用户态 + 内核态，毫秒），不支持的平台返回 -1
+qint64 processCpuTimeMs(qint64 pid);
+
+// 读取进程常驻内存（字节），不支持的平台返回 -1
+qint64 processResidentBytes(qint64 pid);
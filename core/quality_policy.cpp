@@ -0,0 +1,237 @@
+#include "quality_policy.h"
+
+#include "media_cache.h"
+#include "media_session.h"
+#include "metrics.h"
+#include "player_bridge.h"
+#include "player_controller.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QNetworkInformation>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QSettings>
+#include <QTimer>
+#include <QWebEnginePage>
+
+QString QualityPolicy::tierKey(Tier tier) {
+    switch (tier) {
+        case Tier::Standard: return "standard";
+        case Tier::Higher: return "higher";
+        case Tier::ExHigh: return "exhigh";
+        case Tier::Lossless: return "lossless";
+    }
+    return QString();
+}
+
+QString QualityPolicy::tierLabel(Tier tier) {
+    switch (tier) {
+        case Tier::Standard: return "标准";
+        case Tier::Higher: return "较高";
+        case Tier::ExHigh: return "极高";
+        case Tier::Lossless: return "无损";
+    }
+    return QString();
+}
+
+int QualityPolicy::tierKbps(Tier tier) {
+    switch (tier) {
+        case Tier::Standard: return 128;
+        case Tier::Higher: return 192;
+        case Tier::ExHigh: return 320;
+        case Tier::Lossless: return 1000;
+    }
+    return 0;
+}
+
+QualityPolicy::QualityPolicy(PlayerController *player, MediaCache *mediaCache, QObject *parent)
+    : QObject(parent), m_player(player), m_session(player->session()) {
+    m_clock.start();
+    {
+        // quality/mode：auto（默认）或档位名
+        QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+        const QString mode = settings.value("quality/mode", "auto").toString();
+        for (Tier t : tiers()) {
+            if (tierKey(t) == mode) {
+                m_automatic = false;
+                m_tier = t;
+            }
+        }
+    }
+
+    if (mediaCache) {
+        connect(mediaCache, &MediaCache::downloadFinished, this, &QualityPolicy::addThroughputSample);
+        connect(mediaCache, &MediaCache::playStarted, this, &QualityPolicy::probeThroughput);
+    } else {
+        qInfo() << "Media cache disabled, automatic quality has no throughput source and keeps the page setting";
+    }
+    connect(player, &PlayerController::stallReported, this, &QualityPolicy::reportStall);
+    connect(m_session, &MediaSession::metadataChanged, this, &QualityPolicy::onTrackChanged);
+    connect(m_session, &MediaSession::playbackChanged, this, &QualityPolicy::onPlaybackChanged);
+}
+
+QWebEnginePage *QualityPolicy::page() const {
+    return m_player->page();
+}
+
+double QualityPolicy::stallsPerHour() const {
+    qint64 playingMs = m_playingMs;
+    if (m_playingSince.isValid()) playingMs += m_playingSince.elapsed();
+    // 播放不足一分钟时比率没有意义
+    if (playingMs < 60 * 1000) return 0.0;
+    return m_stalls * 3600.0 * 1000.0 / playingMs;
+}
+
+void QualityPolicy::setAutomatic() {
+    m_automatic = true;
+    saveMode();
+    // 还没有吞吐样本时保持页面当前的音质，等有了样本再在切歌时选择
+    if (m_throughputKbps <= 0) return;
+    const Tier tier = chooseTier();
+    if (tier != m_tier || !m_applied) apply(tier);
+}
+
+void QualityPolicy::setManualTier(Tier tier) {
+    m_automatic = false;
+    apply(tier);
+    saveMode();
+}
+
+void QualityPolicy::saveMode() const {
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    settings.setValue("quality/mode", m_automatic ? QString("auto") : tierKey(m_tier));
+}
+
+void QualityPolicy::addThroughputSample(qint64 bytes, qint64 elapsedMs) {
+    // 太小的传输主要反映延迟而不是带宽
+    if (bytes < kMinSampleBytes || elapsedMs <= 0) return;
+    const double kbps = bytes * 8.0 / elapsedMs;
+    m_throughputKbps = m_throughputKbps <= 0 ? kbps : (1 - kSmoothing) * m_throughputKbps + kSmoothing * kbps;
+    m_lastSample.start();
+    Metrics::instance().setCounter("quality_throughput_kbps", qRound64(m_throughputKbps));
+}
+
+void QualityPolicy::probeThroughput(const QUrl &url) {
+    if (!m_automatic || m_probing) return;
+    if (m_lastSample.isValid() && m_lastSample.elapsed() < kProbeIntervalMs) return;
+    m_probing = true;
+    m_probeBytes = 0;
+    m_probeClock.invalidate();
+    Metrics::instance().increment("quality_probes");
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QString::fromLatin1(kPlayerUserAgent));
+    request.setRawHeader("Referer", "https://music.163.com/");
+    request.setRawHeader("Range", "bytes=0-" + QByteArray::number(kProbeBytes - 1));
+    request.setTransferTimeout(15000);
+    QNetworkReply *reply = m_nam.get(request);
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+        const qint64 bytes = reply->readAll().size();
+        // 第一块数据只用来开始计时
+        if (!m_probeClock.isValid()) m_probeClock.start();
+        else m_probeBytes += bytes;
+        // 服务器忽略 Range 返回整个文件时，够了就停止
+        if (m_probeBytes >= kProbeBytes) reply->abort();
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        reply->deleteLater();
+        m_probing = false;
+        const bool aborted = reply->error() == QNetworkReply::OperationCanceledError && m_probeBytes >= kProbeBytes;
+        if (reply->error() != QNetworkReply::NoError && !aborted) {
+            qDebug() << "Throughput probe failed:" << reply->errorString();
+            Metrics::instance().increment("quality_probe_failures");
+            return;
+        }
+        if (!m_probeClock.isValid()) return;
+        addThroughputSample(m_probeBytes, m_probeClock.elapsed());
+    });
+}
+
+QualityPolicy::Tier QualityPolicy::chooseTier() const {
+    if (!m_automatic) return m_tier;
+    // 还没有吞吐样本时不做判断
+    if (m_throughputKbps <= 0) return m_tier;
+
+    Tier best = Tier::Standard;
+    for (Tier t : tiers()) {
+        if (tierKbps(t) * kHeadroom <= m_throughputKbps) best = t;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    const QNetworkInformation *info = QNetworkInformation::instance();
+    if (info && info->supports(QNetworkInformation::Feature::Metered) && info->isMetered()) best = Tier::Standard;
+#endif
+
+    // 最近频繁卡顿：在当前档位基础上降一档
+    if (m_recentStalls.size() >= kStallsToDowngrade && m_tier != Tier::Standard)
+        best = qMin(best, static_cast<Tier>(static_cast<int>(m_tier) - 1));
+    return best;
+}
+
+void QualityPolicy::reportStall(int durationMs) {
+    m_stalls++;
+    const qint64 now = m_clock.elapsed();
+    m_recentStalls.append(now);
+    while (!m_recentStalls.isEmpty() && now - m_recentStalls.first() > kStallWindowMs) m_recentStalls.removeFirst();
+
+    Metrics &metrics = Metrics::instance();
+    metrics.increment("quality_stalls");
+    metrics.addSample("quality_stall", durationMs);
+    metrics.setCounter("quality_stalls_per_hour_x100", qRound64(stallsPerHour() * 100));
+    qDebug().nospace() << "Playback stalled for " << durationMs << " ms (" << m_recentStalls.size()
+                       << " in the last 15 min, " << QString::number(stallsPerHour(), 'f', 1) << "/h)";
+}
+
+void QualityPolicy::onPlaybackChanged() {
+    if (m_session->isPlaying()) {
+        if (!m_playingSince.isValid()) m_playingSince.start();
+    } else if (m_playingSince.isValid()) {
+        m_playingMs += m_playingSince.elapsed();
+        m_playingSince.invalidate();
+    }
+}
+
+void QualityPolicy::onTrackChanged() {
+    if (m_session->trackId() == m_trackId) return;
+    m_trackId = m_session->trackId();
+    const qint64 now = m_clock.elapsed();
+    while (!m_recentStalls.isEmpty() && now - m_recentStalls.first() > kStallWindowMs) m_recentStalls.removeFirst();
+
+    if (m_automatic && m_throughputKbps <= 0) return;
+    const Tier tier = chooseTier();
+    if (tier == m_tier && m_applied) return;
+    apply(tier);
+}
+
+void QualityPolicy::apply(Tier tier, bool retry) {
+    QWebEnginePage *p = page();
+    if (!p) return;
+    if (tier != m_tier) {
+        qInfo().nospace() << "Quality " << (m_automatic ? "auto" : "manual") << ": " << tierKey(m_tier) << " -> "
+                          << tierKey(tier) << " (throughput " << qRound(m_throughputKbps) << " kbps)";
+        m_tier = tier;
+        // 降档后重新开始统计，避免同一批卡顿连续触发
+        m_recentStalls.clear();
+        emit tierChanged(tier);
+    }
+    m_applied = true;
+
+    QPointer<QualityPolicy> self(this);
+    const QString js = QStringLiteral("window.__cmw ? __cmw.setQuality('%1') : null").arg(tierKey(tier));
+    runJavaScriptTimed(p, "setQuality", js, kBridgeWorldId, [self, tier, retry](const QVariant &result) {
+        if (!self) return;
+        const QString status = result.toString();
+        // 只打开了音质菜单：等菜单渲染后再选一次
+        if (status == "opened" && retry) {
+            QTimer::singleShot(500, self, [self, tier]() {
+                if (self) self->apply(tier, false);
+            });
+            return;
+        }
+        const bool ok = status == "ok";
+        Metrics::instance().increment(ok ? "quality_apply_ok" : "quality_apply_failed");
+        if (!ok) qWarning() << "Could not switch quality to" << tierKey(tier) << "in page:" << status;
+    });
+}
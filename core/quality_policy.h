@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+
+class MediaCache;
+class MediaSession;
+class PlayerController;
+class QWebEnginePage;
+
+// 音质策略：根据测得的网络吞吐和卡顿情况选择播放页的音质档位，通过媒体控制桥在页面的音质菜单中切换。
+//   - 吞吐样本来自音频缓存的后台完整下载；最近 kProbeIntervalMs 内没有样本时，在一首未缓存的歌开始播放时
+//     用同一 URL 下载前 kProbeBytes 字节测速（跨域的 Resource Timing 没有 Timing-Allow-Origin 时 transferSize 总是 0，
+//     页面侧无法测量）。样本按指数加权平均；
+//   - 自动模式选择码率 × kHeadroom 不超过吞吐的最高档位；计费网络（QNetworkInformation::isMetered）最多使用标准档；
+//     最近 kStallWindowMs 内卡顿达到 kStallsToDowngrade 次时降一档；
+//   - 档位只在切歌时切换，不打断正在播放的曲目；手动选择的档位（quality/mode）立即生效；
+//   - 卡顿次数、时长与每小时卡顿次数记录在 Metrics 的 quality_* 中。
+class QualityPolicy : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Tier { Standard, Higher, ExHigh, Lossless };
+
+    static QList<Tier> tiers() { return {Tier::Standard, Tier::Higher, Tier::ExHigh, Tier::Lossless}; }
+    // 与网易云音乐接口中的 level 名称一致
+    static QString tierKey(Tier tier);
+    static QString tierLabel(Tier tier);
+    static int tierKbps(Tier tier);
+
+    QualityPolicy(PlayerController *player, MediaCache *mediaCache, QObject *parent = nullptr);
+
+    bool isAutomatic() const { return m_automatic; }
+    // 当前（自动模式下为最近一次选择的）档位
+    Tier tier() const { return m_tier; }
+    // 吞吐估计（kbps），还没有样本时为 0
+    double throughputKbps() const { return m_throughputKbps; }
+    double stallsPerHour() const;
+
+    void setAutomatic();
+    void setManualTier(Tier tier);
+
+    void addThroughputSample(qint64 bytes, qint64 elapsedMs);
+
+signals:
+    void tierChanged(QualityPolicy::Tier tier);
+
+private:
+    QWebEnginePage *page() const;
+    Tier chooseTier() const;
+    void reportStall(int durationMs);
+    void probeThroughput(const QUrl &url);
+    void onTrackChanged();
+    void onPlaybackChanged();
+    void apply(Tier tier, bool retry = true);
+    void saveMode() const;
+
+    static constexpr double kHeadroom = 2.0;
+    static constexpr double kSmoothing = 0.3;
+    static constexpr qint64 kMinSampleBytes = 64 * 1024;
+    static constexpr int kStallWindowMs = 15 * 60 * 1000;
+    static constexpr int kStallsToDowngrade = 2;
+    static constexpr qint64 kProbeBytes = 512 * 1024;
+    static constexpr int kProbeIntervalMs = 10 * 60 * 1000;
+
+    PlayerController *m_player;
+    MediaSession *m_session;
+    QString m_trackId;
+    bool m_automatic = true;
+    Tier m_tier = Tier::ExHigh;
+    bool m_applied = false;
+    double m_throughputKbps = 0.0;
+    qint64 m_stalls = 0;
+    // 最近的卡顿时间点（相对 m_clock），只保留 kStallWindowMs 内的
+    QList<qint64> m_recentStalls;
+    QElapsedTimer m_clock;
+    // 累计播放时长，用于每小时卡顿次数
+    qint64 m_playingMs = 0;
+    QElapsedTimer m_playingSince;
+    QElapsedTimer m_lastSample;
+    // 测速请求：只同时进行一个，计时从收到第一块数据开始，不含连接与首字节延迟
+    QNetworkAccessManager m_nam;
+    bool m_probing = false;
+    qint64 m_probeBytes = 0;
+    QElapsedTimer m_probeClock;
+};
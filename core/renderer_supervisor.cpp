@@ -0,0 +1,94 @@
+#include "renderer_supervisor.h"
+
+#include "media_session.h"
+#include "metrics.h"
+#include "player_controller.h"
+#include "state_store.h"
+
+#include <QDebug>
+#include <QJsonObject>
+
+static const char *terminationStatusName(QWebEnginePage::RenderProcessTerminationStatus status) {
+    switch (status) {
+    case QWebEnginePage::NormalTerminationStatus: return "normal";
+    case QWebEnginePage::AbnormalTerminationStatus: return "abnormal";
+    case QWebEnginePage::CrashedTerminationStatus: return "crashed";
+    case QWebEnginePage::KilledTerminationStatus: return "killed";
+    }
+    return "unknown";
+}
+
+RendererSupervisor::RendererSupervisor(PlayerController *player, QWebEnginePage *page, QObject *parent)
+    : QObject(parent), m_player(player), m_page(page) {
+    m_retryTimer.setSingleShot(true);
+    connect(&m_retryTimer, &QTimer::timeout, this, &RendererSupervisor::reload);
+    connect(page, &QWebEnginePage::renderProcessTerminated, this, &RendererSupervisor::onTerminated);
+    connect(page, &QWebEnginePage::loadFinished, this, &RendererSupervisor::onLoadFinished);
+    connect(player, &PlayerController::restoreFinished, this, [this](bool ok) {
+        if (m_recovering) finishRecovery(ok);
+    });
+}
+
+void RendererSupervisor::onTerminated(QWebEnginePage::RenderProcessTerminationStatus status, int exitCode) {
+    // 正常退出只发生在页面关闭或程序退出时，不需要恢复
+    if (status == QWebEnginePage::NormalTerminationStatus) return;
+
+    Metrics &metrics = Metrics::instance();
+    metrics.increment("renderer_terminated");
+    metrics.increment(QString("renderer_terminated.") + terminationStatusName(status));
+    qWarning().nospace() << "Render process terminated (" << terminationStatusName(status) << ", exit code "
+                         << exitCode << ")";
+
+    // 页面推送的位置最多落后几秒，按 MediaSession 推算的位置写入，恢复时回到退出那一刻。
+    // 若退出时正在恢复，StateStore 会忽略这次更新，保留原先保存的位置
+    StateStore *stateStore = m_player->stateStore();
+    MediaSession *session = m_player->session();
+    QJsonObject state = stateStore->current();
+    if (session->hasTrack() && state.value("id").toString() == session->trackId()) {
+        state.remove("recent");
+        state["time"] = session->position();
+        stateStore->update(state);
+    }
+    stateStore->flush();
+
+    if (!m_recovering) {
+        m_recovering = true;
+        m_recoveryClock.start();
+        if (m_sinceRecovered.isValid() && m_sinceRecovered.elapsed() > kStableAfterMs) m_attempts = 0;
+    }
+    if (m_attempts >= kMaxAttempts) {
+        qWarning() << "Render process keeps terminating, giving up after" << m_attempts << "attempts";
+        metrics.increment("renderer_recovery_given_up");
+        m_recovering = false;
+        return;
+    }
+    // 第一次立即重载，之后倍增等待
+    const int delay = m_attempts == 0 ? 0 : qMin(kMaxRetryDelayMs, kInitialRetryDelayMs << (m_attempts - 1));
+    ++m_attempts;
+    m_retryTimer.start(delay);
+}
+
+void RendererSupervisor::reload() {
+    ++m_restarts;
+    Metrics::instance().increment("renderer_restarts");
+    qInfo() << "Restarting render process, attempt" << m_attempts;
+    // 冻结或被丢弃的页面需要先激活才能加载
+    if (m_page->lifecycleState() != QWebEnginePage::LifecycleState::Active)
+        m_page->setLifecycleState(QWebEnginePage::LifecycleState::Active);
+    m_page->load(PlayerController::playerUrl());
+}
+
+void RendererSupervisor::onLoadFinished(bool ok) {
+    if (!m_recovering || !ok || m_retryTimer.isActive()) return;
+    // 没有可恢复的曲目时，页面加载完成即恢复完成；否则等待 PlayerController 报告恢复结果
+    if (m_player->stateStore()->current().value("id").toString().isEmpty()) finishRecovery(false);
+}
+
+void RendererSupervisor::finishRecovery(bool restored) {
+    m_recovering = false;
+    m_sinceRecovered.start();
+    const qint64 elapsed = m_recoveryClock.elapsed();
+    Metrics::instance().addSample("renderer_recovery", elapsed);
+    qInfo().nospace() << "Recovered from render process termination in " << elapsed << " ms"
+                      << (restored ? ", playback state restored" : "") << " (restart " << m_restarts << ")";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QWebEnginePage>
+
+class PlayerController;
+
+// 渲染进程意外退出（崩溃、被 OOM 杀掉等）后的恢复：
+// 先按 MediaSession 推算的当前位置更新并落盘播放状态，再在同一个 QWebEnginePage 上重新加载。
+// Chromium 为页面启动新的渲染进程，profile 的 HTTP 缓存、Cookie 和所有已建立的连接（视图、托盘、IPC）保持不变，
+// 加载完成后由 PlayerController 的恢复逻辑回到原来的曲目和位置。
+// 恢复前又退出时按 kInitialRetryDelayMs 起倍增延迟重试，连续 kMaxAttempts 次仍失败则放弃。
+class RendererSupervisor : public QObject {
+    Q_OBJECT
+
+public:
+    RendererSupervisor(PlayerController *player, QWebEnginePage *page, QObject *parent = nullptr);
+
+    int restarts() const { return m_restarts; }
+
+private:
+    void onTerminated(QWebEnginePage::RenderProcessTerminationStatus status, int exitCode);
+    void reload();
+    void onLoadFinished(bool ok);
+    void finishRecovery(bool restored);
+
+    static constexpr int kInitialRetryDelayMs = 1000;
+    static constexpr int kMaxRetryDelayMs = 60000;
+    static constexpr int kMaxAttempts = 5;
+    // 恢复后稳定运行超过该时间，再次退出视为新的故障，重新从第一次尝试计
+    static constexpr int kStableAfterMs = 5 * 60 * 1000;
+
+    PlayerController *m_player;
+    QWebEnginePage *m_page;
+    int m_restarts = 0;
+    int m_attempts = 0;
+    bool m_recovering = false;
+    QElapsedTimer m_recoveryClock;
+    QElapsedTimer m_sinceRecovered;
+    QTimer m_retryTimer;
+};
@@ -0,0 +1,62 @@
+#include "request_blocker.h"
+
+#include "metrics.h"
+
+#include <QFile>
+
+static constexpr const char *kDefaultRules[] = {
+    "hm.baidu.com",
+    "google-analytics.com",
+    "googletagmanager.com",
+    "doubleclick.net",
+    "cnzz.com",
+    "umeng.com",
+    "da.netease.com",
+};
+
+RequestBlocker::RequestBlocker(QObject *parent) : QWebEngineUrlRequestInterceptor(parent) {
+    for (const char *host : kDefaultRules) m_rules.insert(QString::fromLatin1(host));
+}
+
+int RequestBlocker::loadRules(const QString &filePath) {
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return 0;
+    int count = 0;
+    while (!f.atEnd()) {
+        QString line = QString::fromUtf8(f.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith('!')) continue;
+        if (line.startsWith("||")) line.remove(0, 2);
+        if (line.endsWith('^')) line.chop(1);
+        if (line.startsWith("*.")) line.remove(0, 2);
+        line = line.toLower();
+        if (line.isEmpty() || line.contains('/')) continue;
+        m_rules.insert(line);
+        count++;
+    }
+    return count;
+}
+
+void RequestBlocker::interceptRequest(QWebEngineUrlRequestInfo &info) {
+    // 不拦截顶层导航，避免影响登录等页面跳转
+    if (info.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeMainFrame) return;
+    const QString host = info.requestUrl().host();
+    const QString rule = matchingRule(host);
+    if (rule.isEmpty()) return;
+    info.block(true);
+    Metrics &metrics = Metrics::instance();
+    metrics.increment("blocked_requests");
+    metrics.increment("blocked_requests." + rule);
+}
+
+QString RequestBlocker::matchingRule(const QString &host) const {
+    if (host.isEmpty() || m_rules.isEmpty()) return QString();
+    const QString h = host.toLower();
+    int pos = 0;
+    while (pos >= 0 && pos < h.size()) {
+        const QString suffix = h.mid(pos);
+        if (m_rules.contains(suffix)) return suffix;
+        pos = h.indexOf('.', pos);
+        if (pos >= 0) pos++;
+    }
+    return QString();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QSet>
+#include <QString>
+#include <QWebEngineUrlRequestInterceptor>
+
+// 请求拦截器：屏蔽统计/广告等播放器不需要的域名。
+// 规则是一组域名，存放在哈希集合中；匹配时从完整 host 开始逐级去掉最左边的标签查表，
+// 例如 a.b.example.com 依次查 a.b.example.com、b.example.com、example.com，耗时只与标签数有关。
+// 被屏蔽的请求记在 Metrics 的 blocked_requests 与按规则域名区分的 blocked_requests.<域名> 计数中；
+// Qt 6 中 interceptRequest 在 UI 线程调用，因此计数无需加锁。
+class RequestBlocker : public QWebEngineUrlRequestInterceptor {
+    Q_OBJECT
+
+public:
+    explicit RequestBlocker(QObject *parent = nullptr);
+
+    // 从文件追加规则：每行一个域名，# 或 ! 开头为注释；兼容 "||example.com^" 写法。返回读取的规则数
+    int loadRules(const QString &filePath);
+
+    int ruleCount() const { return m_rules.size(); }
+
+    void interceptRequest(QWebEngineUrlRequestInfo &info) override;
+
+private:
+    QString matchingRule(const QString &host) const;
+
+    QSet<QString> m_rules;
+};
@@ -0,0 +1,94 @@
+#include "state_store.h"
+
+#include "trace_recorder.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+StateStore::StateStore(const QString &filePath, QObject *parent)
+    : QObject(parent), m_filePath(filePath), m_flushTimer("state.flush", ScheduledJob::Deferrable) {
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(30000);
+    connect(&m_flushTimer, &ScheduledJob::timeout, this, [this]() { flush(); });
+    m_persisted = readFile();
+    m_current = m_persisted;
+}
+
+void StateStore::update(const QJsonObject &state) {
+    if (m_restoreClock.isValid() && m_restoreClock.elapsed() < kRestoreHoldMs) return;
+    // 页面尚未识别出曲目时不改动已保存的状态
+    const QString id = state.value("id").toString();
+    if (id.isEmpty()) return;
+
+    QJsonArray recent = m_current.value("recent").toArray();
+    const QString previousId = m_current.value("id").toString();
+    if (!previousId.isEmpty() && previousId != id) recent = pushRecent(recent, m_current);
+    // 当前曲目不需要重复出现在 recent 中
+    recent = removeFromRecent(recent, id);
+
+    QJsonObject next = state;
+    next["recent"] = recent;
+    m_current = next;
+    if (m_current == m_persisted) {
+        m_flushTimer.stop();
+        return;
+    }
+    TraceRecorder::instance().instant("state", "state.update");
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+bool StateStore::flush() {
+    m_flushTimer.stop();
+    if (m_current == m_persisted) return true;
+    TraceScope trace("state", "state.flush");
+
+    QJsonObject obj = m_current;
+    obj["saved_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    QSaveFile f(m_filePath);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open state file:" << f.errorString();
+        return false;
+    }
+    f.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    if (!f.commit()) {
+        qWarning() << "Failed to write state file:" << f.errorString();
+        return false;
+    }
+    m_persisted = m_current;
+    return true;
+}
+
+QJsonArray StateStore::removeFromRecent(const QJsonArray &recent, const QString &id) {
+    QJsonArray out;
+    for (const QJsonValue &v : recent) {
+        if (v.toObject().value("id").toString() != id) out.append(v);
+    }
+    return out;
+}
+
+QJsonArray StateStore::pushRecent(const QJsonArray &recent, const QJsonObject &track) {
+    QJsonObject entry;
+    entry["id"] = track.value("id");
+    entry["title"] = track.value("title");
+    entry["duration"] = track.value("duration");
+    entry["time"] = track.value("time");
+    QJsonArray out;
+    out.append(entry);
+    const QJsonArray rest = removeFromRecent(recent, track.value("id").toString());
+    for (int i = 0; i < rest.size() && out.size() < kRecentTracks; ++i) out.append(rest.at(i));
+    return out;
+}
+
+QJsonObject StateStore::readFile() const {
+    QFile f(m_filePath);
+    if (!f.open(QIODevice::ReadOnly)) return QJsonObject();
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &err);
+    if (err.error != QJsonParseError::NoError) return QJsonObject();
+    QJsonObject obj = doc.object();
+    obj.remove("saved_at");
+    return obj;
+}
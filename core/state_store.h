@@ -0,0 +1,55 @@
+#pragma once
+
+#include "power_scheduler.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+
+// 播放状态存储：写回式（write-behind）持久化 player_state.json。
+// update() 只更新内存中的状态，与上次写入的内容相同则忽略；有变化时在 flushInterval 后批量写一次
+// （交给 PowerScheduler，省电模式下推迟）。
+// 写入通过 QSaveFile 原子完成，崩溃时不会留下被截断的文件；退出前调用 flush() 同步落盘。
+// 状态以曲目 id 区分：切歌时上一首连同其播放位置进入 recent（最多 kRecentTracks 首），用于之后的快速续播。
+class StateStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StateStore(const QString &filePath, QObject *parent = nullptr);
+
+    QString filePath() const { return m_filePath; }
+
+    void setFlushInterval(int intervalMs) { m_flushTimer.setInterval(intervalMs); }
+
+    // 最新的状态（可能尚未写入磁盘），不含 saved_at
+    QJsonObject current() const { return m_current; }
+
+    // 最近播放过的曲目（不含当前曲目），最新的在前
+    QJsonArray recent() const { return m_current.value("recent").toArray(); }
+
+    // 恢复进行期间页面推送的是尚未 seek 的初始状态（通常位置为 0），不能覆盖保存的位置
+    // 页面没有报告结果时，最多忽略 kRestoreHoldMs
+    void beginRestore() { m_restoreClock.start(); }
+
+    void endRestore() { m_restoreClock.invalidate(); }
+
+    void update(const QJsonObject &state);
+
+    bool flush();
+
+private:
+    static QJsonArray removeFromRecent(const QJsonArray &recent, const QString &id);
+    static QJsonArray pushRecent(const QJsonArray &recent, const QJsonObject &track);
+    QJsonObject readFile() const;
+
+    static constexpr int kRecentTracks = 8;
+    static constexpr int kRestoreHoldMs = 35000;
+
+    QString m_filePath;
+    QJsonObject m_persisted;
+    QJsonObject m_current;
+    ScheduledJob m_flushTimer;
+    QElapsedTimer m_restoreClock;
+};
@@ -0,0 +1,182 @@
+#include "storage_maintenance.h"
+
+#include "cache_policy.h"
+#include "media_session.h"
+#include "metrics.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QPointer>
+#include <QSettings>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWebEnginePage>
+
+namespace {
+
+// 可以清理的存储：都是缓存或临时数据，删除后由 Chromium / 页面按需重建。
+// 清理是删除整个目录，而不是挑出其中过期的条目（Chromium 的存储格式没有可以安全单独删除的条目）
+struct PrunableStore {
+    const char *name;        // 指标与日志中的名称
+    const char *path;        // 相对 storage/ 的路径
+    const char *settingsKey; // 上限（MB），0 表示不限制
+    int defaultMaxMB;
+};
+
+// 默认上限远高于正常使用时空闲测量到的大小，只针对长期失控的增长
+const PrunableStore kPrunableStores[] = {
+    {"service_worker", "Service Worker", "storage/serviceWorkerMaxMB", 200},
+    {"session_storage", "Session Storage", "storage/sessionStorageMaxMB", 50},
+    {"gpu_cache", "GPUCache", "storage/gpuCacheMaxMB", 128},
+    {"blob_storage", "blob_storage", "storage/blobStorageMaxMB", 64},
+};
+
+// 清理后存储重新长到的大小（第一次空闲测量）作为基线；超过基线的这么多倍才会再次清理，
+// 避免正常大小就超过上限的存储在每次启动时都被删掉
+constexpr qint64 kBaselineGrowthFactor = 2;
+
+// 只统计不清理：登录 Cookie、Local Storage（播放页在其中保存播放列表），
+// 以及 IndexedDB（可能保存页面无法重新获取的数据）
+const char *const kPreservedStores[][2] = {
+    {"cookies", "Cookies"},
+    {"local_storage", "Local Storage"},
+    {"indexed_db", "IndexedDB"},
+};
+
+QString baselineKey(const char *store) {
+    return "storage/baselineKB/" + QString::fromLatin1(store);
+}
+
+// 启动时是否执行过清理，用于比较清理前后的启动耗时
+bool prunedThisRun = false;
+
+qint64 storeSize(const QString &path) {
+    const QFileInfo info(path);
+    if (!info.exists()) return 0;
+    return info.isDir() ? directorySize(path) : info.size();
+}
+
+} // namespace
+
+StorageMaintenance::StorageMaintenance(const QString &storagePath, MediaSession *session, QWebEnginePage *page,
+                                       QObject *parent)
+    : QObject(parent), m_storagePath(storagePath), m_session(session),
+      m_timer("storage.maintenance", ScheduledJob::Deferrable) {
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &ScheduledJob::timeout, this, &StorageMaintenance::runIfIdle);
+    m_timer.start(kFirstRunDelayMs);
+    connect(page, &QWebEnginePage::loadFinished, this, &StorageMaintenance::onLoadFinished);
+}
+
+qint64 StorageMaintenance::pruneMarkedStores(const QString &storagePath) {
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    const QStringList pending = settings.value("storage/pendingPrune").toStringList();
+    if (pending.isEmpty()) return 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 freed = 0;
+    for (const PrunableStore &store : kPrunableStores) {
+        if (!pending.contains(QLatin1String(store.name))) continue;
+        const QString path = QDir(storagePath).filePath(QString::fromLatin1(store.path));
+        const qint64 size = storeSize(path);
+        if (QDir(path).removeRecursively()) {
+            freed += size;
+            // -1：下一次空闲测量记为基线
+            settings.setValue(baselineKey(store.name), -1);
+            qInfo().nospace() << "Pruned " << store.name << " (" << formatBytes(size) << ")";
+        } else {
+            qWarning() << "Failed to prune" << path;
+        }
+    }
+    settings.remove("storage/pendingPrune");
+    // 清理后与清理前的启动耗时对比，见 onLoadFinished
+    settings.setValue("storage/loadMsBeforePrune", settings.value("storage/lastLoadMs"));
+    prunedThisRun = true;
+
+    Metrics &metrics = Metrics::instance();
+    metrics.addSample("storage_prune", timer.elapsed());
+    metrics.increment("storage_pruned_kb", freed / 1024);
+    return freed;
+}
+
+void StorageMaintenance::runIfIdle() {
+    if (m_measuring) return;
+    if (m_session && m_session->isPlaying()) {
+        m_timer.start(kBusyRetryMs);
+        return;
+    }
+    m_measuring = true;
+
+    const QString storagePath = m_storagePath;
+    QPointer<StorageMaintenance> self(this);
+    QThreadPool::globalInstance()->start([storagePath, self]() {
+        QHash<QString, qint64> sizes;
+        for (const PrunableStore &store : kPrunableStores)
+            sizes.insert(QString::fromLatin1(store.name), storeSize(QDir(storagePath).filePath(QString::fromLatin1(store.path))));
+        for (const auto &store : kPreservedStores)
+            sizes.insert(QString::fromLatin1(store[0]), storeSize(QDir(storagePath).filePath(QString::fromLatin1(store[1]))));
+        sizes.insert("total", directorySize(storagePath));
+        QMetaObject::invokeMethod(qApp, [self, sizes]() {
+            if (self) self->applyMeasurement(sizes);
+        });
+    });
+}
+
+void StorageMaintenance::applyMeasurement(const QHash<QString, qint64> &sizes) {
+    m_measuring = false;
+    m_timer.start(kRunIntervalMs);
+
+    Metrics &metrics = Metrics::instance();
+    QStringList report;
+    for (auto it = sizes.cbegin(); it != sizes.cend(); ++it) {
+        metrics.setCounter("storage_kb." + it.key(), it.value() / 1024);
+        report << QString("%1 %2").arg(it.key(), formatBytes(it.value()));
+    }
+    report.sort();
+    qInfo().noquote() << "Profile storage:" << report.join(", ");
+
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    QStringList pending;
+    for (const PrunableStore &store : kPrunableStores) {
+        const qint64 maxBytes = settings.value(store.settingsKey, store.defaultMaxMB).toLongLong() * 1024 * 1024;
+        const qint64 size = sizes.value(QString::fromLatin1(store.name));
+        qint64 baselineBytes = settings.value(baselineKey(store.name), 0).toLongLong() * 1024;
+        if (baselineBytes < 0) {
+            baselineBytes = size;
+            settings.setValue(baselineKey(store.name), size / 1024);
+        }
+        if (maxBytes > 0 && size > maxBytes && size > baselineBytes * kBaselineGrowthFactor)
+            pending << QString::fromLatin1(store.name);
+    }
+    if (pending.isEmpty()) {
+        settings.remove("storage/pendingPrune");
+        return;
+    }
+    qInfo().noquote() << "Storage over limit, pruning on next start:" << pending.join(", ");
+    settings.setValue("storage/pendingPrune", pending);
+}
+
+void StorageMaintenance::onLoadFinished(bool ok) {
+    if (!ok || m_loadRecorded) return;
+    m_loadRecorded = true;
+    // 相对进程启动，包含 profile 加载
+    const qint64 loadMs = Metrics::instance().elapsed();
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    settings.setValue("storage/lastLoadMs", loadMs);
+    if (!prunedThisRun) return;
+
+    const qint64 beforeMs = settings.value("storage/loadMsBeforePrune", -1).toLongLong();
+    settings.remove("storage/loadMsBeforePrune");
+    Metrics &metrics = Metrics::instance();
+    metrics.addSample("startup_load_after_prune", loadMs);
+    if (beforeMs >= 0) {
+        metrics.addSample("startup_load_before_prune", beforeMs);
+        qInfo() << "Startup load after pruning:" << loadMs << "ms, before:" << beforeMs << "ms";
+    } else {
+        qInfo() << "Startup load after pruning:" << loadMs << "ms";
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "power_scheduler.h"
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+class MediaSession;
+class QWebEnginePage;
+
+// 持久化 profile（数据目录下的 storage/）的维护：SPA 写入的 IndexedDB、Service Worker 缓存等会无限增长，
+// 拖慢启动时 profile 的加载。
+//   - 空闲时（没有在播放）在线程池中统计各存储的大小，记录为 storage_kb.<name> 计数并输出到日志；
+//   - 可重建的缓存类存储超过上限（storage/<name>MaxMB）、且超过清理后基线的 2 倍时，记入 storage/pendingPrune，
+//     由下次启动在创建 profile 之前整个删除（Chromium 运行期间这些文件正在使用，不能直接删）；
+//   - Cookie、Local Storage（登录状态、播放列表）与 IndexedDB 只统计，从不清理；
+//   - 清理前后首次 loadFinished 的启动耗时写入日志和指标，便于确认效果。
+class StorageMaintenance : public QObject {
+    Q_OBJECT
+
+public:
+    StorageMaintenance(const QString &storagePath, MediaSession *session, QWebEnginePage *page,
+                       QObject *parent = nullptr);
+
+    // 在创建 QWebEngineProfile 之前调用：删除上次维护标记的存储，返回释放的字节数
+    static qint64 pruneMarkedStores(const QString &storagePath);
+
+private:
+    void runIfIdle();
+    void applyMeasurement(const QHash<QString, qint64> &sizes);
+    void onLoadFinished(bool ok);
+
+    static constexpr int kFirstRunDelayMs = 10 * 60 * 1000;
+    static constexpr int kRunIntervalMs = 6 * 60 * 60 * 1000;
+    // 正在播放时推迟到这之后再检查
+    static constexpr int kBusyRetryMs = 10 * 60 * 1000;
+
+    QString m_storagePath;
+    MediaSession *m_session;
+    bool m_measuring = false;
+    bool m_loadRecorded = false;
+    ScheduledJob m_timer;
+};
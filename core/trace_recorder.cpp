@@ -0,0 +1,162 @@
+#include "trace_recorder.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDebug>
+
+#include <chrono>
+#include <cstring>
+
+TraceRecorder &TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+qint64 TraceRecorder::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// 事件名只包含代码中的标识符与命令名，仍做最基本的 JSON 转义
+static QByteArray jsonString(const char *s) {
+    QByteArray out("\"");
+    for (; *s; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        out += c;
+    }
+    out += '"';
+    return out;
+}
+
+bool TraceRecorder::start(const QString &filePath) {
+    if (m_running.load()) return true;
+    m_file = std::make_unique<QFile>(filePath);
+    if (!m_file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot open trace file" << filePath << m_file->errorString();
+        m_file.reset();
+        return false;
+    }
+    if (!m_events) m_events = std::make_unique<Event[]>(kCapacity);
+    m_head.store(0);
+    m_tail.store(0);
+    m_dropped.store(0);
+    m_written = 0;
+    m_pid = QCoreApplication::applicationPid();
+
+    // 进程与线程名称的元数据事件；主线程的 tid 与 pid 相同（与 Chromium 的 CrBrowserMain 一致）
+    const QByteArray name = QCoreApplication::applicationName().toUtf8().replace('"', '\'');
+    m_file->write(QByteArray("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"));
+    m_file->write(QString("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%1,\"tid\":%1,\"args\":{\"name\":\"%2\"}},\n"
+                          "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%1,\"tid\":%1,\"args\":{\"name\":\"GUI\"}}")
+                      .arg(m_pid)
+                      .arg(QString::fromUtf8(name))
+                      .toUtf8());
+
+    m_running.store(true);
+    m_writer = std::thread(&TraceRecorder::writerLoop, this);
+    m_enabled.store(true, std::memory_order_release);
+    qInfo() << "Tracing to" << filePath;
+    return true;
+}
+
+void TraceRecorder::stop() {
+    if (!m_running.load()) return;
+    m_enabled.store(false, std::memory_order_release);
+    m_running.store(false);
+    if (m_writer.joinable()) m_writer.join();
+
+    const qint64 dropped = m_dropped.load();
+    m_file->write(QString("\n],\"otherData\":{\"events\":%1,\"dropped\":%2}}\n").arg(m_written).arg(dropped).toUtf8());
+    m_file->close();
+    qInfo() << "Trace written:" << m_written << "events," << dropped << "dropped";
+    if (dropped > 0) qWarning() << "Trace buffer overflowed, some events were dropped";
+    m_file.reset();
+}
+
+void TraceRecorder::record(char phase, const char *category, const QString &name, qint64 ts, qint64 dur, quint64 id,
+                           qint64 arg) {
+    // 单生产者：只有 GUI 线程会推进 m_head
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t next = (head + 1) & (kCapacity - 1);
+    if (next == m_tail.load(std::memory_order_acquire)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Event &e = m_events[head];
+    e.ts = ts;
+    e.dur = dur;
+    e.id = id;
+    e.arg = arg;
+    e.category = category;
+    e.phase = phase;
+    // 名称过长时截断，且不能把多字节 UTF-8 字符截成一半（否则导出的 JSON 不是合法 UTF-8）
+    const QByteArray utf8 = name.toUtf8();
+    qsizetype length = qMin<qsizetype>(utf8.size(), sizeof(e.name) - 1);
+    if (length < utf8.size()) {
+        // 截断点落在多字节字符中间时（下一个字节是 10xxxxxx 续字节）回退到该字符的起始位置
+        while (length > 0 && (static_cast<unsigned char>(utf8.at(length)) & 0xC0) == 0x80) --length;
+    }
+    memcpy(e.name, utf8.constData(), size_t(length));
+    e.name[length] = '\0';
+    m_head.store(next, std::memory_order_release);
+}
+
+void TraceRecorder::asyncBegin(const char *category, const QString &name, quint64 id) {
+    if (!isEnabled()) return;
+    record('b', category, name, nowUs(), 0, id, -1);
+}
+
+void TraceRecorder::asyncEnd(const char *category, const QString &name, quint64 id, qint64 arg) {
+    if (!isEnabled()) return;
+    record('e', category, name, nowUs(), 0, id, arg);
+}
+
+void TraceRecorder::complete(const char *category, const QString &name, qint64 startUs, qint64 arg) {
+    if (!isEnabled()) return;
+    const qint64 now = nowUs();
+    record('X', category, name, startUs, now - startUs, 0, arg);
+}
+
+void TraceRecorder::instant(const char *category, const QString &name, qint64 arg) {
+    if (!isEnabled()) return;
+    record('i', category, name, nowUs(), 0, 0, arg);
+}
+
+void TraceRecorder::writerLoop() {
+    while (m_running.load()) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    // stop() 之后 GUI 线程不再写入，最后一次取完剩余事件
+    drain();
+}
+
+void TraceRecorder::drain() {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    if (tail == head) return;
+
+    QByteArray chunk;
+    while (tail != head) {
+        const Event &e = m_events[tail];
+        chunk += ",\n{\"ph\":\"";
+        chunk += e.phase;
+        chunk += "\",\"cat\":" + jsonString(e.category) + ",\"name\":" + jsonString(e.name);
+        chunk += ",\"ts\":" + QByteArray::number(e.ts) + ",\"pid\":" + QByteArray::number(m_pid)
+                 + ",\"tid\":" + QByteArray::number(m_pid);
+        if (e.phase == 'X') chunk += ",\"dur\":" + QByteArray::number(e.dur);
+        if (e.phase == 'b' || e.phase == 'e') chunk += ",\"id\":\"0x" + QByteArray::number(e.id, 16) + "\"";
+        // 即时事件只作用于本线程
+        if (e.phase == 'i') chunk += ",\"s\":\"t\"";
+        if (e.arg >= 0) chunk += ",\"args\":{\"value\":" + QByteArray::number(e.arg) + "}";
+        chunk += '}';
+        ++m_written;
+        tail = (tail + 1) & (kCapacity - 1);
+    }
+    // 事件已复制到 chunk，先归还缓冲区再写文件
+    m_tail.store(tail, std::memory_order_release);
+    m_file->write(chunk);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// 可选的事件跟踪（--trace）：记录 runJavaScript 的发出与完成、IPC 消息、状态落盘和页面加载各阶段，
+// 导出为 Chrome about:tracing / Perfetto 可读的 JSON（Trace Event Format）。
+// 时间戳取自 std::chrono::steady_clock（Linux 上为 CLOCK_MONOTONIC，单位微秒），pid/tid 使用本进程（主线程），
+// 与同一会话的 Chromium 跟踪（浏览器进程即本进程）使用同一时钟，可以直接对齐。
+//
+// 事件写入单生产者单消费者的无锁环形缓冲区：只能在 GUI 线程记录；后台线程每 100 ms 把缓冲区写入文件。
+// 缓冲区满时丢弃新事件并计数。未启用时所有记录函数只做一次原子读取。
+class TraceRecorder {
+public:
+    static TraceRecorder &instance();
+
+    // 开始记录并打开输出文件，失败返回 false
+    bool start(const QString &filePath);
+
+    // 写出剩余事件并关闭文件；未启动时什么也不做
+    void stop();
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    static qint64 nowUs();
+
+    // 异步事件（发出与完成可能交错，如 runJavaScript），用 id 配对
+    quint64 nextId() { return ++m_lastId; }
+    void asyncBegin(const char *category, const QString &name, quint64 id);
+    void asyncEnd(const char *category, const QString &name, quint64 id, qint64 arg = -1);
+
+    // 一段已完成的同步操作
+    void complete(const char *category, const QString &name, qint64 startUs, qint64 arg = -1);
+
+    void instant(const char *category, const QString &name, qint64 arg = -1);
+
+private:
+    struct Event {
+        qint64 ts = 0;
+        qint64 dur = 0;
+        quint64 id = 0;
+        qint64 arg = -1;       // 小于 0 表示没有参数
+        const char *category = "";
+        char phase = 'i';
+        char name[48] = {};
+    };
+
+    TraceRecorder() = default;
+    // 没有走到 stop() 就退出时（例如 main 提前返回）仍要结束写线程，否则析构可结合的 std::thread 会 terminate
+    ~TraceRecorder() { stop(); }
+
+    void record(char phase, const char *category, const QString &name, qint64 ts, qint64 dur, quint64 id, qint64 arg);
+    void writerLoop();
+    // 把缓冲区中的事件追加到文件，只在写线程调用
+    void drain();
+
+    static constexpr size_t kCapacity = 1 << 16;
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_running{false};
+    std::atomic<size_t> m_head{0};
+    std::atomic<size_t> m_tail{0};
+    std::atomic<qint64> m_dropped{0};
+    std::unique_ptr<Event[]> m_events;
+    quint64 m_lastId = 0;
+    qint64 m_pid = 0;
+    qint64 m_written = 0;
+    // start() 打开后只由写线程访问，stop() 等写线程结束后再关闭
+    std::unique_ptr<QFile> m_file;
+    std::thread m_writer;
+};
+
+// 作用域内的同步操作，按构造到析构记录为一个完整事件
+class TraceScope {
+public:
+    TraceScope(const char *category, const char *name)
+        : m_category(category), m_name(name),
+          m_startUs(TraceRecorder::instance().isEnabled() ? TraceRecorder::nowUs() : -1) {}
+
+    ~TraceScope() {
+        if (m_startUs >= 0) TraceRecorder::instance().complete(m_category, QString::fromLatin1(m_name), m_startUs);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_startUs;
+};
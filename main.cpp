@@ -1,327 +1,351 @@
 #include <QApplication>
+#include <QGuiApplication>
 #include <QWebEngineView>
-#include <QWebEngineProfile>
-#include <QWebEngineSettings>
 #include <QWebEnginePage>
 #include <QStandardPaths>
 #include <QDir>
-#include <QVBoxLayout>
-#include <QWidget>
 #include <QSystemTrayIcon>
 #include <QMenu>
 #include <QAction>
+#include <QActionGroup>
 #include <QIcon>
 #include <QSettings>
-#include <QCloseEvent>
+#include <QDateTime>
 #include <QDebug>
-#include <QActionGroup>
-#include <QFile>
-#include <QJsonObject>
-#include <QEventLoop>
+#include <QJsonDocument>
 #include <QTimer>
-#include <QLocalServer>
 #include <QLocalSocket>
-#include <QDataStream>
-
-
-// ---------------- helpers ----------------
-
-// 在 QWebEnginePage 上执行 JS，按优先级尝试多个选择器并支持 Shadow DOM，返回是否点击成功
-static bool clickPlayerButton(QWebEnginePage *page, const QString &selectors, int timeoutMs = 1200) {
-    if (!page) return false;
-
-    static const char *js_template = R"JS(
-(function(selectors){
-    function findInRoot(root, sel) {
-        try {
-            var el = root.querySelector(sel);
-            if (el) return el;
-        } catch(e){}
-        var nodes = root.querySelectorAll('*');
-        for (var i=0;i<nodes.length;i++){
-            var n = nodes[i];
-            if (n && n.shadowRoot) {
-                try {
-                    var r = findInRoot(n.shadowRoot, sel);
-                    if (r) return r;
-                } catch(e){}
-            }
-        }
-        return null;
-    }
+#include <QHostInfo>
+#include <QSocketNotifier>
+
+#if defined(Q_OS_UNIX)
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "cache_statistics.h"
+#include "ipc_protocol.h"
+#include "ipc_server.h"
+#include "main_window.h"
+#include "media_cache.h"
+#include "media_key_handler.h"
+#include "media_session.h"
+#include "memory_budget.h"
+#include "metadata_cache.h"
+#include "metrics.h"
+#include "mpris.h"
+#include "player_command.h"
+#include "player_controller.h"
+#include "player_profile.h"
+#include "power_scheduler.h"
+#include "quality_policy.h"
+#include "rendering_profile.h"
+#include "state_store.h"
+#include "storage_maintenance.h"
+#include "trace_recorder.h"
+#include "tray_mode_controller.h"
+
+
+// ---------------- startup helpers ----------------
+
+// 在 QApplication 构造前把内存相关的 Chromium 参数追加到 QTWEBENGINE_CHROMIUM_FLAGS（保留用户已设置的参数）：
+//   memory/rendererProcessLimit  渲染进程数量上限（--renderer-process-limit），默认不限制
+//   memory/jsHeapMB              V8 老生代堆上限（--js-flags=--max-old-space-size），默认不限制
+// renderingFlags 是渲染配置对应的参数（见 rendering_profile.h；无界面模式下为 --disable-gpu）。
+// 这里还不能使用 QApplication::organizationName()，因此直接使用固定的组织名/应用名
+static void applyChromiumFlags(const QStringList &renderingFlags) {
+    QSettings settings("CloudMusicWebPlayer-Qt", "CloudMusicWebPlayer-Qt");
+    QStringList flags;
+    const int processLimit = settings.value("memory/rendererProcessLimit", 0).toInt();
+    if (processLimit > 0) flags << QString("--renderer-process-limit=%1").arg(processLimit);
+    const int jsHeapMB = settings.value("memory/jsHeapMB", 0).toInt();
+    if (jsHeapMB > 0) flags << QString("--js-flags=--max-old-space-size=%1").arg(jsHeapMB);
+    flags << renderingFlags;
+    if (flags.isEmpty()) return;
+
+    QByteArray current = qgetenv("QTWEBENGINE_CHROMIUM_FLAGS");
+    if (!current.isEmpty()) current += ' ';
+    current += flags.join(' ').toLocal8Bit();
+    qputenv("QTWEBENGINE_CHROMIUM_FLAGS", current);
+}
 
-    function dispatchClick(el) {
-        try {
-            el.focus && el.focus();
-            var rect = el.getBoundingClientRect();
-            var clientX = rect.left + rect.width/2;
-            var clientY = rect.top + rect.height/2;
-            ['mousedown','mouseup','click'].forEach(function(type){
-                var ev = new MouseEvent(type, {
-                    view: window,
-                    bubbles: true,
-                    cancelable: true,
-                    clientX: clientX,
-                    clientY: clientY,
-                    button: 0
-                });
-                el.dispatchEvent(ev);
-            });
-            return true;
-        } catch(e){
-            try { el.click(); return true; } catch(e2){ return false; }
-        }
-    }
+// 播放页加载时会用到的主要域名
+static const char *const kPlayerHosts[] = {
+    "music.163.com",
+    "interface.music.163.com",
+    "s1.music.126.net",
+    "s2.music.126.net",
+    "p1.music.126.net",
+    "p2.music.126.net",
+    "m701.music.126.net",
+    "m801.music.126.net",
+};
 
-    var list = [];
-    if (Array.isArray(selectors)) list = selectors;
-    else list = String(selectors).split(',').map(function(s){ return s.trim(); }).filter(Boolean);
-
-    for (var i=0;i<list.length;i++){
-        var sel = list[i];
-        try {
-            var el = document.querySelector(sel);
-            if (!el) el = findInRoot(document, sel);
-            if (el) {
-                if (dispatchClick(el)) return true;
-            }
-        } catch(e){}
+// 在后台线程解析播放页相关域名。Chromium 自身的连接池无法从外部预热，
+// 这里只能让系统解析器（如 systemd-resolved、Windows DNS Client）提前缓存结果，
+// 使随后 Chromium 的 DNS 查询命中缓存。每个域名的解析耗时记录为 dns_prefetch 样本。
+static void prefetchPlayerHosts(QObject *context) {
+    for (const char *host : kPlayerHosts) {
+        QElapsedTimer timer;
+        timer.start();
+        QHostInfo::lookupHost(QString::fromLatin1(host), context, [timer](const QHostInfo &info) {
+            if (info.error() == QHostInfo::NoError)
+                Metrics::instance().addSample("dns_prefetch", timer.elapsed());
+        });
     }
+}
 
-    var fallback = [
-        '#btn_pc_minibar_play',
-        'button.play-btn',
-        'button.playorPauseIconStyle_p5dzjle',
-        'button[title=\"播放\"]',
-        'button[title=\"暂停\"]',
-        'button[title=\"上一首\"]',
-        'button[title=\"下一首\"]',
-        'button .cmd-icon.cmd-icon-pre',
-        'button .cmd-icon.cmd-icon-next'
-    ];
-    for (var j=0;j<fallback.length;j++){
-        try {
-            var e2 = document.querySelector(fallback[j]) || findInRoot(document, fallback[j]);
-            if (e2 && dispatchClick(e2)) return true;
-        } catch(e){}
+// --trace[=文件]：记录事件跟踪（见 trace_recorder.h），默认写入数据目录下的 trace-<时间>.json。
+// 需要在 QCoreApplication 设置好应用名、并确认没有运行中的实例之后调用
+static void startTraceFromArguments(const QStringList &args) {
+    QString path;
+    for (const QString &arg : args) {
+        if (arg == "--trace") {
+            const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+            QDir().mkpath(dir);
+            path = dir + "/trace-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json";
+        } else if (arg.startsWith("--trace=")) {
+            path = arg.mid(int(qstrlen("--trace=")));
+        }
     }
+    if (!path.isEmpty()) TraceRecorder::instance().start(path);
+}
 
-    return false;
-})
-)JS";
-
-    // 需要对 selectors 做 JS 字符串转义（避免引号/反斜杠问题）
-    QString esc = selectors;
-    esc.replace('\\', "\\\\");
-    esc.replace('\'', "\\'");
-    esc.replace('\n', "\\n");
-    // 将转义后的 selectors 作为单引号字符串传入 JS
-    QString js = QString::fromUtf8(js_template) + QString::fromUtf8("\n('%1');").arg(esc);
-
-    bool result = false;
-    QEventLoop loop;
-    page->runJavaScript(js, [&result, &loop](const QVariant &v) {
-        result = v.toBool();
-        loop.quit();
-    });
-    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
-    loop.exec();
-    return result;
+// 事件循环结束（aboutToQuit 处理完）后写完跟踪文件
+static int execAndFinishTrace(QCoreApplication &app) {
+    const int ret = app.exec();
+    TraceRecorder::instance().stop();
+    return ret;
 }
 
+// 已有实例在运行时发送激活消息并返回 true。激活仍发送旧版裸消息，兼容更早版本的运行实例
+static bool activateRunningInstance(const QString &serverName) {
+    if (!singleInstanceMayBeRunning(serverName)) return false;
+    QLocalSocket probeSocket;
+    probeSocket.connectToServer(serverName, QIODevice::ReadWrite);
+    if (!probeSocket.waitForConnected(200)) return false;
+    writeIpcFrame(&probeSocket, "activate");
+    probeSocket.flush();
+    probeSocket.disconnectFromServer();
+    return true;
+}
 
-// ---------------- MainWindow ----------------
+// memory/budgetMB：渲染进程内存预算，0（默认）表示不启用
+static void applyMemoryBudget(QWebEnginePage *page, PlayerController *player) {
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    const qint64 budgetMB = settings.value("memory/budgetMB", 0).toLongLong();
+    if (budgetMB <= 0) return;
+    MemoryBudget *budget = new MemoryBudget(page, player->stateStore(), budgetMB * 1024 * 1024, page);
+    budget->setSampleInterval(settings.value("memory/sampleIntervalSec", 60).toInt() * 1000);
+}
 
-class MainWindow : public QWidget {
-    Q_OBJECT
+// --metrics：把指标写入数据目录下的 metrics.json 并输出到日志
+static void writeMetrics(const QString &dataDir) {
+    PowerScheduler::instance().updateMetrics();
+    const Metrics &metrics = Metrics::instance();
+    const QString metricsFile = dataDir + "/metrics.json";
+    if (metrics.writeJson(metricsFile)) qInfo() << "Metrics written to" << metricsFile;
+    qInfo().noquote() << QJsonDocument(metrics.toJson()).toJson(QJsonDocument::Compact);
+}
 
-public:
-    MainWindow(QWebEngineView *view, QSystemTrayIcon *trayIcon, const QString &stateFilePath, QWidget *parent = nullptr)
-        : QWidget(parent), m_view(view), m_trayIcon(trayIcon), m_stateFilePath(stateFilePath) {
-        QVBoxLayout *layout = new QVBoxLayout;
+// 托盘菜单中的音质选择：自动（显示当前自动选择的档位）或手动固定某一档
+static void setupQualityMenu(QMenu *menu, QualityPolicy *quality) {
+    QActionGroup *group = new QActionGroup(menu);
+    group->setExclusive(true);
+    QAction *autoAction = menu->addAction("自动");
+    autoAction->setCheckable(true);
+    autoAction->setActionGroup(group);
+    autoAction->setChecked(quality->isAutomatic());
+    menu->addSeparator();
+    for (QualityPolicy::Tier tier : QualityPolicy::tiers()) {
+        QAction *action = menu->addAction(QualityPolicy::tierLabel(tier));
+        action->setCheckable(true);
+        action->setActionGroup(group);
+        action->setChecked(!quality->isAutomatic() && quality->tier() == tier);
+        QObject::connect(action, &QAction::triggered, quality, [quality, tier]() { quality->setManualTier(tier); });
+    }
+    QObject::connect(autoAction, &QAction::triggered, quality, [quality]() { quality->setAutomatic(); });
+
+    const auto updateAutoText = [autoAction, quality]() {
+        autoAction->setText(quality->isAutomatic() && quality->throughputKbps() > 0
+                                ? QString("自动（%1）").arg(QualityPolicy::tierLabel(quality->tier()))
+                                : QString("自动"));
+    };
+    QObject::connect(quality, &QualityPolicy::tierChanged, autoAction, updateAutoText);
+    QObject::connect(autoAction, &QAction::triggered, autoAction, updateAutoText);
+    menu->setEnabled(true);
+}
 
-        // 关键：去掉边距和间距，让 webview 铺满整个窗口
-        layout->setContentsMargins(0, 0, 0, 0);
-        layout->setSpacing(0);
+#if defined(Q_OS_UNIX)
+static int quitSignalFd[2] = {-1, -1};
 
-        // 确保 view 可以扩展填满布局
-        view->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-        view->setContentsMargins(0, 0, 0, 0);
+static void quitSignalHandler(int) {
+    const char c = 1;
+    [[maybe_unused]] const ssize_t n = ::write(quitSignalFd[0], &c, sizeof(c));
+}
 
-        layout->addWidget(view);
-        setLayout(layout);
-        resize(1200, 800);
-        setWindowTitle("网易云音乐 Web 播放器");
-        loadSettings();
+// 作为服务运行时通过 SIGTERM/SIGINT 停止：转到事件循环里正常退出，保证状态落盘和指标写出
+static void installQuitSignalHandlers(QCoreApplication *app) {
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, quitSignalFd) != 0) {
+        qWarning() << "Cannot create signal socket pair, SIGTERM will not flush state";
+        return;
     }
+    QSocketNotifier *notifier = new QSocketNotifier(quitSignalFd[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, [notifier]() {
+        notifier->setEnabled(false);
+        char c;
+        [[maybe_unused]] const ssize_t n = ::read(quitSignalFd[1], &c, sizeof(c));
+        QCoreApplication::quit();
+    });
+    struct sigaction action = {};
+    action.sa_handler = quitSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+}
+#endif
 
-    void closeEvent(QCloseEvent *event) override {
-        if (m_closeToTray) {
-            hide();
-            event->ignore();
-        } else {
-            saveSettings();
-            event->accept();
-            QApplication::quit();
-        }
-    }
+// ---------------- headless ----------------
 
-    // 公共接口：读取/设置关闭到托盘行为
-    bool closeToTray() const { return m_closeToTray; }
+// --headless：只有播放页，没有窗口、托盘和 QWidget，只能通过 IPC（cloudmusic-ctl）和 MPRIS 控制。
+// 页面不挂到任何视图上，Chromium 不需要合成输出；未指定 QT_QPA_PLATFORM 时使用 offscreen 平台插件，
+// 不需要显示服务器。
+static int runHeadless(int argc, char *argv[]) {
+    Metrics &metrics = Metrics::instance();
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
 
-    void setCloseToTray(bool closeToTray) {
-        m_closeToTray = closeToTray;
-        saveSettings();
-    }
+    // WebEngine 需要 QGuiApplication，但不需要 QApplication 和 widgets
+    QGuiApplication app(argc, argv);
+    app.setOrganizationName("CloudMusicWebPlayer-Qt");
+    app.setApplicationName("CloudMusicWebPlayer-Qt");
+    app.setQuitOnLastWindowClosed(false);
+    metrics.mark("app_ready");
 
-    void loadSettings() {
-        QSettings settings(QApplication::organizationName(), QApplication::applicationName());
-        m_closeToTray = settings.value("closeToTray", true).toBool();
-    }
+    const bool metricsEnabled = app.arguments().contains("--metrics");
+    const QString serverName = ipcServerName();
+    prefetchPlayerHosts(&app);
 
-    void saveSettings() {
-        QSettings settings(QApplication::organizationName(), QApplication::applicationName());
-        settings.setValue("closeToTray", m_closeToTray);
+    if (activateRunningInstance(serverName)) {
+        qWarning() << "Another instance is already running";
+        return 1;
     }
+    // 确认没有运行中的实例后才开始跟踪，避免覆盖正在运行的实例的跟踪文件
+    startTraceFromArguments(app.arguments());
+    metrics.mark("instance_probe_done");
+
+    IpcServer *ipcServer = new IpcServer(&app);
+    ipcServer->listen(serverName);
+    QObject::connect(ipcServer, &IpcServer::activateRequested, &app, []() {
+        qDebug() << "Running headless, ignoring activate request";
+    });
 
-    QString stateFilePath() const { return m_stateFilePath; }
-
-private:
-    QWebEngineView *m_view;
-    QSystemTrayIcon *m_trayIcon;
-    bool m_closeToTray = true;
-    QString m_stateFilePath;
-};
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
 
-// ---------------- JS snippets ----------------
-
-// JS to read player state: returns JSON string with id, time, paused
-static const char *js_read_state = R"JS(
-(function(){
-    try {
-        var id = location.hash || location.pathname || document.title || 'unknown';
-        var audio = document.querySelector('audio');
-        var time = 0;
-        var paused = true;
-        if (audio) {
-            time = audio.currentTime || 0;
-            paused = audio.paused;
-        } else {
-            if (window.player && window.player.getCurrentTime) {
-                try { time = window.player.getCurrentTime(); } catch(e) {}
-            }
-            if (window.player && window.player.isPlaying) {
-                try { paused = !window.player.isPlaying(); } catch(e) {}
-            }
-        }
-        return JSON.stringify({id: String(id), time: Number(time), paused: Boolean(paused)});
-    } catch(e) {
-        return JSON.stringify({id:'unknown', time:0, paused:true});
+    PlayerController *player = new PlayerController(dataDir + "/player_state.json", &app);
+    {
+        QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+        player->stateStore()->setFlushInterval(settings.value("stateFlushIntervalMs", 30000).toInt());
     }
-})();
-)JS";
-
-// JS to restore state: expects a JSON object {id, time, paused}
-static const char *js_restore_state_template = R"JS(
-(function(state){
-    try {
-        var audio = document.querySelector('audio');
-        if (audio && state && typeof state.time === 'number') {
-            var setOnce = function() {
-                try {
-                    if (audio.readyState > 0) {
-                        audio.currentTime = Math.min(state.time, audio.duration || state.time);
-                        if (!state.paused) audio.play().catch(function(){});
-                        return true;
-                    }
-                } catch(e){}
-                return false;
-            };
-            if (!setOnce()) {
-                var tries = 0;
-                var t = setInterval(function(){
-                    tries++;
-                    if (setOnce() || tries > 20) clearInterval(t);
-                }, 500);
-            }
-        } else {
-            if (window.player && window.player.seek) {
-                try { window.player.seek(state.time); if (!state.paused) window.player.play(); } catch(e) {}
-            }
-        }
-    } catch(e){}
-})(%1);
-)JS";
+    player->setMetadataCache(new MetadataCache(dataDir + "/metadata", player));
+    MediaSession *mediaSession = player->session();
+    mediaSession->setCanRaise(false);
+    QObject::connect(mediaSession, &MediaSession::quitRequested, &app, &QCoreApplication::quit);
+#if defined(CMW_HAVE_DBUS)
+    registerMprisService(mediaSession);
+#endif
+    ipcServer->setPlayer(player);
+#if defined(Q_OS_UNIX)
+    installQuitSignalHandlers(&app);
+#endif
+
+    const PlayerProfile profile = createPlayerProfile(dataDir, &app);
+    QWebEnginePage *page = createPlayerPage(profile, &app);
+    player->attachPage(page);
+    applyMemoryBudget(page, player);
+    new StorageMaintenance(dataDir + "/storage", player->session(), page, page);
+    new QualityPolicy(player, profile.mediaCache, page);
+    // 没有界面，没在播放时即视为空闲，后台任务进入省电调度
+    PowerScheduler::instance().setIdle(!mediaSession->isPlaying());
+    QObject::connect(mediaSession, &MediaSession::playbackChanged, &app, [mediaSession]() {
+        PowerScheduler::instance().setIdle(!mediaSession->isPlaying());
+    });
+    metrics.mark("view_ready");
+    player->load();
+    qInfo() << "Running headless, control with cloudmusic-ctl or MPRIS";
+
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, [metricsEnabled, dataDir, player, ipcServer]() {
+        player->shutdown();
+        if (metricsEnabled) writeMetrics(dataDir);
+        ipcServer->close();
+    });
+
+    return execAndFinishTrace(app);
+}
 
 // ---------------- main ----------------
 
 int main(int argc, char *argv[]) {
+    // 启动各阶段相对进程启动的耗时，用于分析冷启动
+    Metrics &metrics = Metrics::instance();
+    metrics.start();
+
+    // 控制命令（--next、--status 等）只需转发给运行中的实例：
+    // 仅构造 QCoreApplication，不加载 GUI 平台插件，也不初始化 WebEngine
+    QStringList args;
+    for (int i = 0; i < argc; ++i) args << QString::fromLocal8Bit(argv[i]);
+    RemoteCommand remoteCommand;
+    if (parseRemoteCommand(args, &remoteCommand)) {
+        QCoreApplication core(argc, argv);
+        return runRemoteCommand(remoteCommand);
+    }
+
+    const bool headless = args.contains("--headless");
+    registerMediaCacheScheme();
+    // 无界面模式没有画面需要合成，直接关闭 GPU 进程，不使用渲染配置
+    applyChromiumFlags(headless ? QStringList{"--disable-gpu"} : applyRenderingProfile(args));
+    if (headless) return runHeadless(argc, argv);
+
     QApplication app(argc, argv);
     app.setOrganizationName("CloudMusicWebPlayer-Qt");
     app.setApplicationName("CloudMusicWebPlayer-Qt");
+    metrics.mark("app_ready");
+
+    // --metrics：退出前把指标写入数据目录下的 metrics.json
+    const bool metricsEnabled = app.arguments().contains("--metrics");
 
     // 单例相关：使用 QLocalServer/QLocalSocket
-    const QString instanceKey = QString("%1-%2")
-        .arg(QCoreApplication::applicationName())
-        .arg(qgetenv("CloudMusicWebPlayer-Qt")); // 可根据需要改为更唯一的标识
-    const QString serverName = instanceKey + "-single-instance";
+    const QString serverName = ipcServerName();
 
-    // 先尝试连接到已有实例
-    QLocalSocket probeSocket;
-    probeSocket.connectToServer(serverName, QIODevice::WriteOnly);
-    if (probeSocket.waitForConnected(500)) {
-        // 已有实例：发送激活消息并退出
-        QByteArray msg = "activate";
-        QDataStream out(&probeSocket);
-        out.setVersion(QDataStream::Qt_5_15);
-        out << msg;
-        probeSocket.flush();
-        probeSocket.disconnectFromServer();
-        return 0;
-    }
+    // 探测已有实例的同时，提前解析播放页相关域名，和探测时间重叠
+    prefetchPlayerHosts(&app);
+
+    // 先尝试连接到已有实例：有则激活它并退出
+    if (activateRunningInstance(serverName)) return 0;
+    // 确认没有运行中的实例后才开始跟踪，避免覆盖正在运行的实例的跟踪文件
+    startTraceFromArguments(app.arguments());
+    metrics.mark("instance_probe_done");
 
     // 没有实例：创建 server 并监听
-    // 先移除可能残留的 socket 文件，避免 listen 失败
-    QLocalServer::removeServer(serverName);
-    QLocalServer *localServer = new QLocalServer(&app);
-    if (!localServer->listen(serverName)) {
-        qWarning() << "Failed to listen on local server:" << localServer->errorString();
-        // 继续运行但无法接收激活请求
-    }
-    
+    IpcServer *ipcServer = new IpcServer(&app);
+    ipcServer->listen(serverName);
+
     QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QDir().mkpath(dataDir);
 
     QString stateFile = dataDir + "/player_state.json";
 
-    QWebEngineProfile *profile = new QWebEngineProfile("CloudMusicWebPlayer-Qt", &app);
-    profile->setPersistentStoragePath(dataDir + "/storage");
-    profile->setCachePath(dataDir + "/cache");
-    profile->setHttpCacheType(QWebEngineProfile::DiskHttpCache);
-    profile->setHttpCacheMaximumSize(200 * 1024 * 1024);
-    profile->setPersistentCookiesPolicy(QWebEngineProfile::ForcePersistentCookies);
-    profile->setHttpUserAgent(
-        "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120 Safari/537.36");
-
-    // 注意：某些 Qt 版本没有 ServiceWorkersEnabled 枚举，故不调用该属性以保证兼容性
-    profile->settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
-    profile->settings()->setAttribute(QWebEngineSettings::LocalStorageEnabled, true);
-    profile->settings()->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, true);
-    profile->settings()->setAttribute(QWebEngineSettings::PluginsEnabled, true);
-
-    QWebEnginePage *page = new QWebEnginePage(profile, &app);
-    QWebEngineView *view = new QWebEngineView;
-    view->setPage(page);
-
-    QUrl playerUrl("https://music.163.com/st/webplayer");
-    view->load(playerUrl);
-
-    QObject::connect(view, &QWebEngineView::urlChanged, [view, playerUrl](const QUrl &url) {
-        if (!url.isValid() || url.host() != "music.163.com") {
-            qDebug() << "Redirecting to player page...";
-            view->load(playerUrl);
-        }
-    });
+    // 命令、播放状态与持久化都由 PlayerController 负责；页面在 WebEngine 初始化后才接入，此前的命令会排队
+    PlayerController *player = new PlayerController(stateFile, &app);
+    {
+        QSettings settings(QApplication::organizationName(), QApplication::applicationName());
+        player->stateStore()->setFlushInterval(settings.value("stateFlushIntervalMs", 30000).toInt());
+    }
+    player->setMetadataCache(new MetadataCache(dataDir + "/metadata", player));
+    PlayerCommandDispatcher *dispatcher = player->dispatcher();
+    MediaSession *mediaSession = player->session();
 
     // tray icon and window
     QSystemTrayIcon *trayIcon = new QSystemTrayIcon(&app);
@@ -331,35 +355,41 @@ int main(int argc, char *argv[]) {
     trayIcon->setIcon(icon);
     trayIcon->setToolTip("网易云音乐 Web 播放器");
 
-    MainWindow *window = new MainWindow(view, trayIcon, stateFile);
-    window->setWindowIcon(icon);
+    // 曲目变化时更新托盘提示；tray/trackNotifications 为 true 时，窗口隐藏期间还会弹出通知。
+    // 内容都来自 MediaSession（页面推送 + 元数据缓存），不访问页面
+    QObject::connect(mediaSession, &MediaSession::metadataChanged, trayIcon, [trayIcon, mediaSession]() {
+        if (!mediaSession->hasTrack()) return;
+        QStringList lines{mediaSession->title()};
+        if (!mediaSession->artist().isEmpty()) lines << mediaSession->artist();
+        if (!mediaSession->album().isEmpty()) lines << mediaSession->album();
+        trayIcon->setToolTip(lines.join('\n'));
+    });
 
-    // 当 localServer 收到新连接时，读取消息并激活窗口
-    if (localServer && localServer->isListening()) {
-        QObject::connect(localServer, &QLocalServer::newConnection, [&]() {
-            QLocalSocket *client = localServer->nextPendingConnection();
-            if (!client) return;
-            QObject::connect(client, &QLocalSocket::readyRead, [client, window]() {
-                QDataStream in(client);
-                in.setVersion(QDataStream::Qt_5_15);
-                QByteArray msg;
-                in >> msg;
-                // 简单协议：收到 "activate" 就显示主窗口
-                if (msg == "activate") {
-                    if (!window->isVisible() || window->isMinimized()) {
-                        window->showNormal();
-                    }
-                    window->raise();
-                    window->activateWindow();
-                }
-                client->disconnectFromServer();
-                client->deleteLater();
-            });
-            // 如果客户端没有发送数据，确保连接被清理
-            QObject::connect(client, &QLocalSocket::disconnected, client, &QLocalSocket::deleteLater);
+    MainWindow *window = new MainWindow(trayIcon, stateFile);
+    window->setWindowIcon(icon);
+    window->setPlaceholderState(player->stateStore()->current());
+
+    if (QSettings(QApplication::organizationName(), QApplication::applicationName())
+            .value("tray/trackNotifications", false).toBool()) {
+        QObject::connect(mediaSession, &MediaSession::metadataChanged, trayIcon,
+                         [trayIcon, window, mediaSession, lastId = QString()]() mutable {
+            if (!mediaSession->hasTrack() || mediaSession->trackId() == lastId || window->isVisible()) return;
+            lastId = mediaSession->trackId();
+            const QIcon art(mediaSession->artFile());
+            if (art.isNull()) trayIcon->showMessage(mediaSession->title(), mediaSession->artist());
+            else trayIcon->showMessage(mediaSession->title(), mediaSession->artist(), art);
         });
     }
 
+    // 其他实例请求激活时显示主窗口
+    QObject::connect(ipcServer, &IpcServer::activateRequested, window, [window]() {
+        if (!window->isVisible() || window->isMinimized()) {
+            window->showNormal();
+        }
+        window->raise();
+        window->activateWindow();
+    });
+
     QMenu *trayMenu = new QMenu();
     QAction *showAction = trayMenu->addAction("打开主窗口");
     trayMenu->addSeparator();
@@ -378,6 +408,11 @@ int main(int argc, char *argv[]) {
     exitDirectlyAction->setCheckable(true);
     exitDirectlyAction->setActionGroup(behaviorGroup);
     trayMenu->addMenu(closeBehaviorMenu);
+    // 页面就绪后才可用
+    QMenu *qualityMenu = trayMenu->addMenu("音质");
+    qualityMenu->setEnabled(false);
+    QAction *cacheStatsAction = trayMenu->addAction("缓存统计…");
+    cacheStatsAction->setEnabled(false);
     trayMenu->addSeparator();
     QAction *quitAction = trayMenu->addAction("退出");
 
@@ -397,36 +432,39 @@ int main(int argc, char *argv[]) {
         window->activateWindow();
     });
 
-    QObject::connect(playPauseAction, &QAction::triggered, [page]() {
-        QString sel =
-                "#btn_pc_minibar_play, button.play-btn, button.playorPauseIconStyle_p5dzjle, button.play-pause-btn, button[title=\"播放\"], button[title=\"暂停\"], span.cmd-icon.cmd-icon-play";
-        bool ok = clickPlayerButton(page, sel);
-        if (!ok) {
-            qWarning() << "PlayPause click failed";
-        }
+    QObject::connect(playPauseAction, &QAction::triggered, [dispatcher]() {
+        dispatcher->dispatch(PlayerCommand::PlayPause, [](bool ok, qint64) {
+            if (!ok) qWarning() << "PlayPause click failed";
+        });
     });
 
-    QObject::connect(prevAction, &QAction::triggered, [page]() {
-        QString sel =
-                "button[title=\"上一首\"], span.cmd-icon.cmd-icon-pre, button[aria-label=\"pre\"], button.cmd-icon-pre, button .cmd-icon.cmd-icon-pre";
-        bool ok = clickPlayerButton(page, sel);
-        if (!ok) {
-            qWarning() << "Previous click failed";
-        }
+    QObject::connect(prevAction, &QAction::triggered, [dispatcher]() {
+        dispatcher->dispatch(PlayerCommand::Previous, [](bool ok, qint64) {
+            if (!ok) qWarning() << "Previous click failed";
+        });
     });
 
-    QObject::connect(nextAction, &QAction::triggered, [page]() {
-        QString sel =
-                "button[title=\"下一首\"], span.cmd-icon.cmd-icon-next, button[aria-label=\"next\"], button.cmd-icon-next, button .cmd-icon.cmd-icon-next";
-        bool ok = clickPlayerButton(page, sel);
-        if (!ok) {
-            qWarning() << "Next click failed";
-        }
+    QObject::connect(nextAction, &QAction::triggered, [dispatcher]() {
+        dispatcher->dispatch(PlayerCommand::Next, [](bool ok, qint64) {
+            if (!ok) qWarning() << "Next click failed";
+        });
     });
 
 
     QObject::connect(quitAction, &QAction::triggered, [&app]() { app.quit(); });
 
+    QObject::connect(mediaSession, &MediaSession::raiseRequested, window, [window]() {
+        window->showNormal();
+        window->raise();
+        window->activateWindow();
+    });
+    QObject::connect(mediaSession, &MediaSession::quitRequested, &app, &QApplication::quit);
+#if defined(CMW_HAVE_DBUS)
+    registerMprisService(mediaSession);
+#endif
+    new MediaKeyHandler(mediaSession, &app);
+    ipcServer->setPlayer(player);
+
     QObject::connect(trayIcon, &QSystemTrayIcon::activated, [window](QSystemTrayIcon::ActivationReason reason) {
         if (reason == QSystemTrayIcon::Trigger || reason == QSystemTrayIcon::DoubleClick) {
             if (!window->isVisible() || window->isMinimized()) {
@@ -442,71 +480,49 @@ int main(int argc, char *argv[]) {
     trayIcon->setContextMenu(trayMenu);
     trayIcon->show();
     window->show();
-
-    // ---------------- state persistence logic ----------------
-
-    QTimer *stateTimer = new QTimer(&app);
-    stateTimer->setInterval(4000); // 4s
-    QObject::connect(stateTimer, &QTimer::timeout, [page, stateFile]() {
-        page->runJavaScript(QString::fromUtf8(js_read_state), [stateFile](const QVariant &result) {
-            if (!result.isValid()) return;
-            QString jsonStr = result.toString();
-            if (jsonStr.isEmpty()) return;
-            QJsonParseError err;
-            QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8(), &err);
-            if (err.error != QJsonParseError::NoError) {
-                QFile f(stateFile);
-                if (f.open(QIODevice::WriteOnly)) {
-                    f.write(jsonStr.toUtf8());
-                    f.close();
-                }
-                return;
-            }
-            QJsonObject obj = doc.object();
-            obj["saved_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
-            QJsonDocument out(obj);
-            QFile f(stateFile);
-            if (f.open(QIODevice::WriteOnly)) {
-                f.write(out.toJson(QJsonDocument::Compact));
-                f.close();
-            }
+    metrics.mark("tray_visible");
+
+    // 渲染能力探测（仅 auto 配置且尚无结果时）放到启动完成之后，不和页面加载争抢
+    QTimer::singleShot(10000, &app, &probeRenderingIfNeeded);
+
+    // ---------------- WebEngine (deferred) ----------------
+
+    // Chromium 初始化与页面加载放到下一轮事件循环，托盘和窗口外壳先显示出来
+    QTimer::singleShot(0, &app, [&app, &metrics, dataDir, window, player, qualityMenu, cacheStatsAction]() {
+        metrics.mark("webengine_init");
+
+        const PlayerProfile profile = createPlayerProfile(dataDir, &app);
+        QWebEnginePage *page = createPlayerPage(profile, &app);
+        player->attachPage(page);
+        QWebEngineView *view = new QWebEngineView;
+        view->setPage(page);
+        window->setView(view);
+        new TrayModeController(page, window, &app);
+        // 托盘模式把页面冻结（隐藏且静音一段时间）后，后台任务进入省电调度
+        QObject::connect(page, &QWebEnginePage::lifecycleStateChanged, &app,
+                         [](QWebEnginePage::LifecycleState state) {
+            PowerScheduler::instance().setIdle(state != QWebEnginePage::LifecycleState::Active);
         });
-    });
-    stateTimer->start();
-
-    QObject::connect(view, &QWebEngineView::loadFinished, [page, stateFile](bool ok) {
-        if (!ok) return;
-        QFile f(stateFile);
-        if (!f.exists()) return;
-        if (!f.open(QIODevice::ReadOnly)) return;
-        QByteArray data = f.readAll();
-        f.close();
-        QJsonParseError err;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-        if (err.error != QJsonParseError::NoError) return;
-        QJsonObject obj = doc.object();
-        QJsonObject state;
-        state["id"] = obj.value("id").toString(obj.value("id").toString());
-        state["time"] = obj.value("time").toDouble(0.0);
-        state["paused"] = obj.value("paused").toBool(true);
-        QJsonDocument sdoc(state);
-        QString stateJson = QString::fromUtf8(sdoc.toJson(QJsonDocument::Compact));
-        QString js = QString::fromUtf8(js_restore_state_template).arg(stateJson);
-        page->runJavaScript(js);
+        MediaCache *mediaCache = profile.mediaCache;
+        QObject::connect(cacheStatsAction, &QAction::triggered, page, [window, page, mediaCache, dataDir]() {
+            showCacheStatistics(window, page, mediaCache, dataDir + "/cache");
+        });
+        cacheStatsAction->setEnabled(true);
+        applyMemoryBudget(page, player);
+        new StorageMaintenance(dataDir + "/storage", player->session(), page, page);
+        setupQualityMenu(qualityMenu, new QualityPolicy(player, profile.mediaCache, page));
+        metrics.mark("view_ready");
+
+        player->load();
     });
 
-    QObject::connect(&app, &QApplication::aboutToQuit, [trayIcon, window, stateTimer, localServer]() {
-        stateTimer->stop();
+    QObject::connect(&app, &QApplication::aboutToQuit, [metricsEnabled, dataDir, trayIcon, window, player, ipcServer]() {
+        player->shutdown();
+        if (metricsEnabled) writeMetrics(dataDir);
         window->saveSettings();
         if (trayIcon->isVisible()) trayIcon->hide();
-        if (localServer) {
-            localServer->close();
-            // removeServer 以清理 socket 文件
-            QLocalServer::removeServer(localServer->serverName());
-        }
+        ipcServer->close();
     });
 
-    return app.exec();
+    return execAndFinishTrace(app);
 }
-
-#include "main.moc"
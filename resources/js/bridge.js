@@ -0,0 +1,537 @@
+// 媒体控制桥：通过 QWebEngineScript 在每个文档 DocumentReady 时注入一次（独立的 ApplicationWorld），
+// 在页面中常驻 window.__cmw，C++ 侧之后只需发送 "__cmw.next()" 这类很短的调用。
+// 注意：ApplicationWorld 与页面脚本隔离，只共享 DOM，看不到页面自己的全局变量。
+(function(){
+    if (window.__cmw) return;
+
+    // 每个命令按优先级排列的选择器
+    var COMMANDS = {
+        playPause: [
+            '#btn_pc_minibar_play',
+            'button.play-btn',
+            'button.playorPauseIconStyle_p5dzjle',
+            'button.play-pause-btn',
+            'button[title="播放"]',
+            'button[title="暂停"]',
+            'span.cmd-icon.cmd-icon-play'
+        ],
+        prev: [
+            'button[title="上一首"]',
+            'span.cmd-icon.cmd-icon-pre',
+            'button[aria-label="pre"]',
+            'button.cmd-icon-pre',
+            'button .cmd-icon.cmd-icon-pre'
+        ],
+        next: [
+            'button[title="下一首"]',
+            'span.cmd-icon.cmd-icon-next',
+            'button[aria-label="next"]',
+            'button.cmd-icon-next',
+            'button .cmd-icon.cmd-icon-next'
+        ]
+    };
+
+    function findInRoot(root, sel) {
+        try {
+            var el = root.querySelector(sel);
+            if (el) return el;
+        } catch(e){}
+        var nodes = root.querySelectorAll('*');
+        for (var i=0;i<nodes.length;i++){
+            var n = nodes[i];
+            if (n && n.shadowRoot) {
+                try {
+                    var r = findInRoot(n.shadowRoot, sel);
+                    if (r) return r;
+                } catch(e){}
+            }
+        }
+        return null;
+    }
+
+    function dispatchClick(el) {
+        try {
+            el.focus && el.focus();
+            var rect = el.getBoundingClientRect();
+            var clientX = rect.left + rect.width/2;
+            var clientY = rect.top + rect.height/2;
+            ['mousedown','mouseup','click'].forEach(function(type){
+                var ev = new MouseEvent(type, {
+                    view: window,
+                    bubbles: true,
+                    cancelable: true,
+                    clientX: clientX,
+                    clientY: clientY,
+                    button: 0
+                });
+                el.dispatchEvent(ev);
+            });
+            return true;
+        } catch(e){
+            try { el.click(); return true; } catch(e2){ return false; }
+        }
+    }
+
+    // 已解析元素缓存：命中时不再遍历 DOM。只在 MutationObserver 发现缓存元素被移除时失效，
+    // 此外命中前还会检查 isConnected（观察范围之外或 Shadow DOM 内的替换也能被发现）。
+    var cache = {};
+    var stats = {hits: 0, misses: 0, invalidations: 0};
+    var observer = null;
+    var observedRoot = null;
+
+    function parentOf(node) {
+        return node.parentNode || node.host || null;
+    }
+
+    function contains(root, node) {
+        for (var n = node; n; n = parentOf(n)) {
+            if (n === root) return true;
+        }
+        return false;
+    }
+
+    function commonAncestor(a, b) {
+        for (var n = a; n; n = parentOf(n)) {
+            if (contains(n, b)) return n;
+        }
+        return document.body || document.documentElement;
+    }
+
+    function onMutations(records) {
+        var names = Object.keys(cache);
+        if (!names.length) return;
+        for (var i=0;i<records.length;i++){
+            var removed = records[i].removedNodes;
+            for (var j=0;j<removed.length;j++){
+                for (var k=0;k<names.length;k++){
+                    var el = cache[names[k]];
+                    if (el && (removed[j] === el || (removed[j].contains && removed[j].contains(el)))) {
+                        delete cache[names[k]];
+                        stats.invalidations++;
+                    }
+                }
+            }
+        }
+    }
+
+    // 观察范围限定在包含所有已缓存按钮的最小子树（即播放栏），而不是整个文档
+    function observe(el) {
+        var root = observedRoot ? commonAncestor(observedRoot, el) : (parentOf(el) || el);
+        if (root === observedRoot) return;
+        if (!observer) observer = new MutationObserver(onMutations);
+        observer.disconnect();
+        observedRoot = root;
+        try { observer.observe(root, {childList: true, subtree: true}); } catch(e){}
+    }
+
+    function resolve(name) {
+        var el = cache[name];
+        if (el && el.isConnected) {
+            stats.hits++;
+            return el;
+        }
+        if (el) {
+            delete cache[name];
+            stats.invalidations++;
+        }
+        stats.misses++;
+        var list = COMMANDS[name] || [];
+        for (var i=0;i<list.length;i++){
+            try {
+                el = findInRoot(document, list[i]);
+                if (el) {
+                    cache[name] = el;
+                    observe(el);
+                    return el;
+                }
+            } catch(e){}
+        }
+        return null;
+    }
+
+    function click(name) {
+        if (!COMMANDS[name]) return false;
+        var el = resolve(name);
+        return !!(el && dispatchClick(el));
+    }
+
+    function seekTo(seconds) {
+        var audio = currentAudio();
+        if (!audio || !isFinite(seconds)) return false;
+        audio.currentTime = Math.max(0, Math.min(seconds, audio.duration || seconds));
+        return true;
+    }
+
+    // 批次中的一项：命令名，或带参数的 [命令名, 值]
+    function exec(item) {
+        var name = Array.isArray(item) ? item[0] : item;
+        var value = Array.isArray(item) ? Number(item[1]) : 0;
+        var audio;
+        switch (name) {
+            case 'play':
+                audio = currentAudio();
+                return (audio && !audio.paused) ? true : click('playPause');
+            case 'pause':
+                audio = currentAudio();
+                return (audio && audio.paused) ? true : click('playPause');
+            case 'seek':
+                return seekTo(value);
+            case 'seekBy':
+                audio = currentAudio();
+                return !!audio && seekTo((audio.currentTime || 0) + value);
+            default:
+                return click(name);
+        }
+    }
+
+    function cacheStats() {
+        return {hits: stats.hits, misses: stats.misses, invalidations: stats.invalidations};
+    }
+
+    // 最近一次触发媒体事件的 <audio>，页面可能同时存在多个媒体元素
+    var lastAudio = null;
+
+    function currentAudio() {
+        if (lastAudio && lastAudio.isConnected) return lastAudio;
+        return document.querySelector('audio');
+    }
+
+    // ---- 曲目识别 ----
+    // 优先从播放栏中的歌曲链接（song?id=123 或 /song/123）取真实歌曲 id；
+    // 取不到时用标题 + 歌手 + 时长组合出一个 "t:" 开头的替代 id。标题优先取自 navigator.mediaSession。
+    var PLAYBAR_SELECTORS = ['#g_player', '.m-playbar', '[class*="minibar"]', '[class*="playbar"]', '[class*="player-bar"]'];
+    var SONG_LINK = 'a[href*="song?id="], a[href*="/song/"]';
+
+    function playbarRoot() {
+        if (observedRoot && observedRoot.querySelector && observedRoot.isConnected !== false) return observedRoot;
+        for (var i=0;i<PLAYBAR_SELECTORS.length;i++){
+            var el = findInRoot(document, PLAYBAR_SELECTORS[i]);
+            if (el) return el;
+        }
+        return null;
+    }
+
+    function trackInfo(audio) {
+        var info = {id: '', title: '', artist: '', album: '', artUrl: '', duration: 0};
+        if (audio && isFinite(audio.duration)) info.duration = audio.duration;
+        try {
+            var md = navigator.mediaSession && navigator.mediaSession.metadata;
+            if (md) {
+                info.title = md.title || '';
+                info.artist = md.artist || '';
+                info.album = md.album || '';
+                // artwork 一般按尺寸从小到大排列，取最后一张
+                if (md.artwork && md.artwork.length) info.artUrl = md.artwork[md.artwork.length - 1].src || '';
+            }
+        } catch(e){}
+        var root = playbarRoot();
+        var link = root ? root.querySelector(SONG_LINK) : null;
+        if (link) {
+            var m = /song(?:\?id=|\/)(\d+)/.exec(link.getAttribute('href') || '');
+            if (m) info.id = m[1];
+            if (!info.title) info.title = (link.textContent || '').trim();
+        }
+        if (!info.id && info.title)
+            info.id = 't:' + info.title + '|' + info.artist + '|' + Math.round(info.duration);
+        return info;
+    }
+
+    // ---- 播放列表中的下一首：供 C++ 侧预取元数据 ----
+    // 播放页把播放列表保存在 localStorage 的 track-queue（[{id, ...}]）中，只在曲目变化时解析一次
+    var queueFor = null;
+    var queueNext = '';
+
+    function nextTrackId(id) {
+        if (!id || id === queueFor) return queueNext;
+        queueFor = id;
+        queueNext = '';
+        try {
+            var queue = JSON.parse(localStorage.getItem('track-queue') || '[]');
+            for (var i=0;i<queue.length;i++){
+                if (String(queue[i].id) !== id) continue;
+                var next = queue[(i + 1) % queue.length];
+                if (next && next.id) queueNext = String(next.id);
+                break;
+            }
+        } catch(e){}
+        return queueNext;
+    }
+
+    function state() {
+        try {
+            var audio = currentAudio();
+            var info = trackInfo(audio);
+            info.next = nextTrackId(info.id);
+            info.time = audio ? (audio.currentTime || 0) : 0;
+            info.paused = audio ? Boolean(audio.paused) : true;
+            info.route = location.hash || location.pathname || '';
+            return JSON.stringify(info);
+        } catch(e) {
+            return JSON.stringify({id: '', time: 0, paused: true});
+        }
+    }
+
+    // ---- 播放状态推送：监听 <audio> 事件，通过 QWebChannel 把变化推给 C++ ----
+    // 离散事件立即推送；timeupdate 只在距上次推送超过 PUSH_INTERVAL_MS 时推送。
+    // 暂停时没有任何媒体事件，因此页面和 C++ 侧都不会被唤醒。
+    var PUSH_INTERVAL_MS = 5000;
+    var host = null;
+    var lastPushAt = 0;
+    var lastPushed = '';
+
+    function pushState(force) {
+        if (!host) return;
+        var now = Date.now();
+        if (!force && now - lastPushAt < PUSH_INTERVAL_MS) return;
+        var s = state();
+        if (s === lastPushed) return;
+        lastPushAt = now;
+        lastPushed = s;
+        try { host.pushState(s); } catch(e){}
+    }
+
+    function onMediaEvent(e) {
+        if (!e.target || e.target.tagName !== 'AUDIO') return;
+        lastAudio = e.target;
+        pushState(e.type !== 'timeupdate');
+    }
+
+    // 媒体事件不冒泡，但捕获阶段会经过 document，因此无需等待 <audio> 出现再绑定
+    ['timeupdate', 'play', 'pause', 'ended', 'loadedmetadata', 'seeked'].forEach(function(type){
+        document.addEventListener(type, onMediaEvent, true);
+    });
+
+    // ---- 卡顿：播放中缓冲耗尽（waiting）到恢复播放（playing）的时长 ----
+    // seek 引起的缓冲和曲目开头的首次缓冲不算卡顿
+    var stallStart = 0;
+    var seeking = false;
+
+    document.addEventListener('seeking', function(e){
+        if (e.target && e.target.tagName === 'AUDIO') seeking = true;
+    }, true);
+    document.addEventListener('waiting', function(e){
+        var a = e.target;
+        if (!a || a.tagName !== 'AUDIO' || seeking || a.paused || (a.currentTime || 0) < 0.5) return;
+        stallStart = Date.now();
+    }, true);
+    document.addEventListener('playing', function(e){
+        if (!e.target || e.target.tagName !== 'AUDIO') return;
+        seeking = false;
+        if (!stallStart) return;
+        var ms = Date.now() - stallStart;
+        stallStart = 0;
+        try { if (host) host.reportStall(ms); } catch(err){}
+    }, true);
+    document.addEventListener('seeked', function(e){
+        if (e.target && e.target.tagName === 'AUDIO') seeking = false;
+    }, true);
+
+    // ---- 音质：按档位文字在页面的音质菜单中查找选项（启发式，页面改版后可能需要更新选择器）----
+    var QUALITY_LABELS = {
+        standard: ['标准'],
+        higher: ['较高'],
+        exhigh: ['极高', 'HQ'],
+        lossless: ['无损', 'SQ']
+    };
+    var QUALITY_OPTIONS = '[class*="quality"] li, [class*="quality"] [role="menuitem"], [class*="quality"] [role="option"], '
+                        + '[class*="brt"] li, [class*="level"] li';
+    var QUALITY_TOGGLES = ['button[title*="音质"]', '[class*="quality-btn"]', '[class*="quality"] button', '[class*="brt"]'];
+    var SELECTED_CLASS = /(^|[\s-])(active|selected|cur|z-sel|checked)(\s|$)/;
+
+    function findAllInRoot(root, sel, out) {
+        try { Array.prototype.push.apply(out, root.querySelectorAll(sel)); } catch(e){}
+        var nodes = root.querySelectorAll('*');
+        for (var i=0;i<nodes.length;i++){
+            if (nodes[i] && nodes[i].shadowRoot) findAllInRoot(nodes[i].shadowRoot, sel, out);
+        }
+        return out;
+    }
+
+    // 返回 'ok'（已选中或已点击对应选项）、'opened'（只打开了音质菜单，需要稍后再调用一次）、
+    // 'unavailable'（找不到音质控件）或 'unknown-level'
+    function setQuality(level) {
+        var labels = QUALITY_LABELS[level];
+        if (!labels) return 'unknown-level';
+        var options = findAllInRoot(document, QUALITY_OPTIONS, []);
+        for (var i=0;i<options.length;i++){
+            var text = (options[i].textContent || '').trim();
+            for (var j=0;j<labels.length;j++){
+                if (text.indexOf(labels[j]) !== 0) continue;
+                if (SELECTED_CLASS.test(options[i].className || '')) return 'ok';
+                return dispatchClick(options[i]) ? 'ok' : 'unavailable';
+            }
+        }
+        for (var k=0;k<QUALITY_TOGGLES.length;k++){
+            var toggle = findInRoot(document, QUALITY_TOGGLES[k]);
+            if (toggle) return dispatchClick(toggle) ? 'opened' : 'unavailable';
+        }
+        return 'unavailable';
+    }
+
+    // ---- 状态恢复：事件驱动，不轮询 ----
+    // 用 MutationObserver 等待 <audio> 出现，在 loadedmetadata / canplay 时识别曲目并立即 seek，
+    // 结果（成功与否、总耗时、音频就绪到 seek 完成的延迟）通过 QWebChannel 报告给 C++。
+    var RESTORE_TIMEOUT_MS = 30000;
+    var pendingRestoreReport = null;
+
+    function reportRestore(result) {
+        if (!host) {
+            pendingRestoreReport = result;
+            return;
+        }
+        try { host.restoreFinished(JSON.stringify(result)); } catch(e){}
+    }
+
+    // saved = {current: {id, time, paused, duration}, recent: [{id, time, duration}, ...]}
+    // 只有页面当前加载的曲目与 current 或 recent 中某一项 id 相同时才 seek 到该项保存的位置
+    function restore(saved) {
+        if (!saved || !saved.current) return false;
+        var candidates = [saved.current].concat(saved.recent || []).filter(function(c){
+            return c && c.id && typeof c.time === 'number';
+        });
+        if (!candidates.length) return false;
+        var startedAt = Date.now();
+        var done = false;
+        var observer = null;
+        var watched = [];
+        var ready = null;
+        var readyAt = 0;
+        var timer = null;
+
+        function finish(ok, reason, extra) {
+            if (done) return;
+            done = true;
+            if (observer) observer.disconnect();
+            if (timer) clearTimeout(timer);
+            watched.forEach(function(a){
+                a.removeEventListener('loadedmetadata', onReady);
+                a.removeEventListener('canplay', onReady);
+            });
+            var now = Date.now();
+            var result = {ok: ok, reason: reason, totalMs: now - startedAt,
+                          readyDelayMs: readyAt ? now - readyAt : -1};
+            if (extra) for (var k in extra) result[k] = extra[k];
+            reportRestore(result);
+        }
+
+        // 音频就绪后识别曲目；播放栏可能稍晚才更新，识别不到时等待下一次 DOM 变化或媒体事件
+        function tryApply() {
+            if (done || !ready) return;
+            var info = trackInfo(ready);
+            if (!info.id) return;
+            var match = null;
+            for (var i=0;i<candidates.length;i++){
+                if (candidates[i].id === info.id) { match = candidates[i]; break; }
+            }
+            if (!match) {
+                finish(false, 'track-mismatch', {trackId: info.id});
+                return;
+            }
+            try {
+                ready.currentTime = Math.min(match.time, ready.duration || match.time);
+                if (match === saved.current && !saved.current.paused) ready.play().catch(function(){});
+                lastAudio = ready;
+                finish(true, match === saved.current ? 'seeked' : 'seeked-recent', {trackId: info.id});
+            } catch(e) {
+                finish(false, 'seek-error', {trackId: info.id});
+            }
+        }
+
+        function markReady(audio) {
+            if (!ready) {
+                ready = audio;
+                readyAt = Date.now();
+            }
+            tryApply();
+        }
+
+        function onReady(e) {
+            if (!done) markReady(e.target);
+        }
+
+        function watch(audio) {
+            if (done || watched.indexOf(audio) >= 0) return;
+            watched.push(audio);
+            audio.addEventListener('loadedmetadata', onReady);
+            audio.addEventListener('canplay', onReady);
+            if (audio.readyState > 0) markReady(audio);
+        }
+
+        var existing = document.querySelectorAll('audio');
+        for (var i=0;i<existing.length && !done;i++) watch(existing[i]);
+        if (done) return true;
+
+        observer = new MutationObserver(function(records){
+            for (var i=0;i<records.length && !done;i++){
+                var added = records[i].addedNodes;
+                for (var j=0;j<added.length && !done;j++){
+                    var n = added[j];
+                    if (n.tagName === 'AUDIO') watch(n);
+                    else if (n.querySelectorAll) {
+                        var found = n.querySelectorAll('audio');
+                        for (var k=0;k<found.length && !done;k++) watch(found[k]);
+                    }
+                }
+            }
+            tryApply();
+        });
+        observer.observe(document.documentElement, {childList: true, subtree: true, characterData: true});
+        timer = setTimeout(function(){
+            finish(false, ready ? 'track-unknown' : (watched.length ? 'audio-not-ready' : 'no-audio'));
+        }, RESTORE_TIMEOUT_MS);
+        return true;
+    }
+
+    if (typeof QWebChannel !== 'undefined' && typeof qt !== 'undefined' && qt.webChannelTransport) {
+        new QWebChannel(qt.webChannelTransport, function(channel){
+            host = channel.objects.cmwHost;
+            if (!host) return;
+            try { host.hello(); } catch(e){}
+            pushState(true);
+            if (pendingRestoreReport) {
+                reportRestore(pendingRestoreReport);
+                pendingRestoreReport = null;
+            }
+        });
+    }
+
+    // 根据 Resource Timing 统计页面资源的 HTTP 缓存命中情况：
+    // transferSize 为 0 且有内容的资源来自缓存
+    // 跨域且没有 Timing-Allow-Origin 的资源（如 CDN 上的图片、脚本）transferSize 与 decodedBodySize 都是 0，
+    // 无法判断是否命中缓存，单独计为 opaque
+    function resourceStats() {
+        var total = 0, cached = 0, transferred = 0, opaque = 0;
+        try {
+            var entries = performance.getEntriesByType('resource');
+            for (var i=0;i<entries.length;i++){
+                var e = entries[i];
+                if (!e.decodedBodySize) { opaque++; continue; }
+                total++;
+                if (e.transferSize === 0) cached++;
+                transferred += e.transferSize || 0;
+            }
+        } catch(e){}
+        return {total: total, cached: cached, transferred: transferred, opaque: opaque};
+    }
+
+    window.__cmw = {
+        playPause: function(){ return click('playPause'); },
+        prev: function(){ return click('prev'); },
+        next: function(){ return click('next'); },
+        state: state,
+        restore: restore,
+        stats: cacheStats,
+        resourceStats: resourceStats,
+        setQuality: setQuality,
+        // 按顺序执行一批命令，返回每条命令是否点击成功以及元素缓存计数
+        run: function(batch){
+            var results = [];
+            for (var i=0;i<batch.length;i++){
+                var ok = false;
+                try { ok = exec(batch[i]); } catch(e){}
+                results.push(ok);
+            }
+            return {results: results, cache: cacheStats()};
+        }
+    };
+})();